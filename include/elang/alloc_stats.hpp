@@ -0,0 +1,26 @@
+#ifndef ELANG_ALLOC_STATS_H
+#define ELANG_ALLOC_STATS_H
+
+#include <cstddef>
+
+namespace elang {
+namespace util {
+
+// Global allocations since the start of the program. A program using these
+// gets the global operator new replaced by a counting one.
+struct AllocationStats {
+    std::size_t count;
+    std::size_t bytes;
+
+    friend AllocationStats operator-(AllocationStats lhs,
+                                     AllocationStats rhs) {
+        return {lhs.count - rhs.count, lhs.bytes - rhs.bytes};
+    }
+};
+
+AllocationStats allocationStats();
+
+} // namespace util
+} // namespace elang
+
+#endif // ELANG_ALLOC_STATS_H
@@ -0,0 +1,123 @@
+#ifndef ELANG_ARENA_H
+#define ELANG_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace elang {
+namespace util {
+
+// view over a contiguous array owned by someone else, usually an Arena
+template <class T>
+class Span {
+    T* _data;
+    std::size_t _size;
+
+  public:
+    Span() : _data(nullptr), _size(0) {
+    }
+    Span(T* data, std::size_t size) : _data(data), _size(size) {
+    }
+    // read-only view over a mutable span
+    template <class U,
+              class = std::enable_if_t<std::is_same<const U, T>::value>>
+    Span(Span<U> other) : _data(other.begin()), _size(other.size()) {
+    }
+
+    T* begin() const {
+        return _data;
+    }
+    T* end() const {
+        return _data + _size;
+    }
+    std::size_t size() const {
+        return _size;
+    }
+    bool empty() const {
+        return _size == 0;
+    }
+    T& operator[](std::size_t index) const {
+        return _data[index];
+    }
+};
+
+// Bump-pointer allocator: everything allocated from it is released at once
+// when it is destroyed, without running any destructor. Only trivially
+// destructible objects can be made in it.
+class Arena {
+    std::vector<std::unique_ptr<char[]>> _blocks;
+    char* _current;
+    char* _end;
+    std::size_t _allocated; // in blocks
+    std::size_t _used;
+
+  public:
+    Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment) {
+        auto address = reinterpret_cast<std::uintptr_t>(_current);
+        auto padding = (alignment - address % alignment) % alignment;
+        if (padding + size > static_cast<std::size_t>(_end - _current)) {
+            return allocateSlow(size, alignment);
+        }
+        auto result = _current + padding;
+        _current = result + size;
+        _used += size;
+        return result;
+    }
+
+    template <class T, class... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    Span<T> copy(Span<const T> elements) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "arena objects are never destroyed");
+        if (elements.empty()) {
+            return {};
+        }
+        auto data = static_cast<T*>(
+            allocate(sizeof(T) * elements.size(), alignof(T)));
+        std::uninitialized_copy(elements.begin(), elements.end(), data);
+        return {data, elements.size()};
+    }
+    template <class T>
+    Span<T> copy(const std::vector<T>& elements) {
+        return copy(Span<const T>{elements.data(), elements.size()});
+    }
+
+    // frees every block, whatever was allocated from the arena is gone
+    void reset();
+
+    // takes over the blocks of other, which is left empty: what was
+    // allocated from other now lives as long as this arena
+    void adopt(Arena& other);
+
+    // bytes handed out, and bytes reserved from the system
+    std::size_t bytesUsed() const {
+        return _used;
+    }
+    std::size_t bytesAllocated() const {
+        return _allocated;
+    }
+
+  private:
+    void* allocateSlow(std::size_t size, std::size_t alignment);
+};
+
+} // namespace util
+} // namespace elang
+
+#endif // ELANG_ARENA_H
@@ -1,34 +1,62 @@
 #ifndef ELANG_AST_H
 #define ELANG_AST_H
 
-#include <memory>
-#include <string>
-#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <utility>
 
+#include <elang/arena.hpp>
 #include <elang/source_location.hpp>
+#include <elang/string_interner.hpp>
 #include <elang/type.hpp>
 
 namespace elang {
+
+class BodyLoader;
+
 namespace ast {
 
 // useful forward decl
-class Visitor;
 class VarDecl;
 class IdentifierReference;
 
+// concrete node classes, see StaticVisitor for the dispatch
+enum class NodeKind : std::uint8_t {
+    BinaryOperator,
+    UnaryOperator,
+    SubscriptExpression,
+    CallExpression,
+    CastExpression,
+    LValueToRValueCastExpression,
+    IdentifierReference,
+    IntLiteral,
+    DoubleLiteral,
+    CharLiteral,
+    StringLiteral,
+    BoolLiteral,
+    CompoundStatement,
+    LetStatement,
+    ExpressionStatement,
+    SelectionStatement,
+    IterationStatement,
+    ReturnStatement,
+    FunctionDeclaration,
+    FunctionDefinition,
+    Module
+};
+
 class Node {
   public:
-    explicit Node(SourceLocation loc);
-    virtual void accept(Visitor* visitor) = 0;
+    Node(NodeKind node_kind, SourceLocation loc);
 
+    NodeKind node_kind;
     SourceLocation location;
 };
 
 class Expression : public Node {
   public:
-    explicit Expression(SourceLocation loc);
-    virtual void accept(Visitor* visitor) = 0;
-    virtual bool isComputable() = 0;
+    Expression(NodeKind node_kind, SourceLocation loc);
+    bool isComputable() const;
 
     Type* type{nullptr};
 };
@@ -52,90 +80,70 @@ class BinaryOperator : public Expression {
         LogicalOr
     };
 
-    BinaryOperator(Kind kind, std::unique_ptr<Expression> lhs,
-                   std::unique_ptr<Expression> rhs, SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
+    BinaryOperator(Kind kind, Expression* lhs, Expression* rhs,
+                   SourceLocation loc);
 
     Kind kind;
-    std::unique_ptr<Expression> lhs;
-    std::unique_ptr<Expression> rhs;
+    Expression* lhs;
+    Expression* rhs;
 };
 
 class UnaryOperator : public Expression {
   public:
     enum class Kind { Plus, Minus, LogicalNot, PtrDeref, AddressOf };
 
-    UnaryOperator(Kind kind, std::unique_ptr<Expression> expr,
-                  SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
+    UnaryOperator(Kind kind, Expression* expr, SourceLocation loc);
 
     Kind kind;
-    std::unique_ptr<Expression> expr;
+    Expression* expr;
 };
 
 class SubscriptExpression : public Expression {
   public:
-    SubscriptExpression(std::unique_ptr<Expression> subscripted,
-                        std::unique_ptr<Expression> index, SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
+    SubscriptExpression(Expression* subscripted, Expression* index,
+                        SourceLocation loc);
 
-    std::unique_ptr<Expression> subscripted;
-    std::unique_ptr<Expression> index;
+    Expression* subscripted;
+    Expression* index;
 };
 
 class CallExpression : public Expression {
   public:
-    CallExpression(std::unique_ptr<IdentifierReference> func,
-                   std::vector<std::unique_ptr<Expression>> args,
+    CallExpression(IdentifierReference* func, util::Span<Expression*> args,
                    SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
 
-    std::unique_ptr<IdentifierReference> func;
-    std::vector<std::unique_ptr<Expression>> args;
+    IdentifierReference* func;
+    util::Span<Expression*> args;
 };
 
 class CastExpression : public Expression {
   public:
-    CastExpression(std::unique_ptr<Expression> casted, Type* to_type,
-                   SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
+    CastExpression(Expression* casted, Type* to_type, SourceLocation loc);
 
-    std::unique_ptr<Expression> casted;
+    Expression* casted;
     Type* to_type;
 };
 
 class LValueToRValueCastExpression : public Expression {
   public:
-    explicit LValueToRValueCastExpression(std::unique_ptr<Expression> lvalue,
+    explicit LValueToRValueCastExpression(Expression* lvalue,
                                           SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
 
-    std::unique_ptr<Expression> lvalue;
+    Expression* lvalue;
 };
 
 class IdentifierReference : public Expression {
   public:
-    explicit IdentifierReference(std::string name,
-                                 std::vector<std::string> module_path,
+    explicit IdentifierReference(Symbol name, util::Span<Symbol> module_path,
                                  SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
 
-    std::string name;
-    std::vector<std::string> module_path;
+    Symbol name;
+    util::Span<Symbol> module_path;
 };
 
 class IntLiteral : public Expression {
   public:
     explicit IntLiteral(unsigned long value, SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
 
     unsigned long value;
 };
@@ -143,8 +151,6 @@ class IntLiteral : public Expression {
 class DoubleLiteral : public Expression {
   public:
     explicit DoubleLiteral(double value, SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
 
     double value;
 };
@@ -152,137 +158,124 @@ class DoubleLiteral : public Expression {
 class CharLiteral : public Expression {
   public:
     explicit CharLiteral(char value, SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
 
     char value;
 };
 
 class StringLiteral : public Expression {
   public:
-    explicit StringLiteral(std::string value, SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
+    explicit StringLiteral(std::string_view value, SourceLocation loc);
 
-    std::string value;
+    std::string_view value;
 };
 
 class BoolLiteral : public Expression {
   public:
     explicit BoolLiteral(bool value, SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-    virtual bool isComputable() override;
 
     bool value;
 };
 
 class Statement : public Node {
   public:
-    explicit Statement(SourceLocation loc);
-    virtual void accept(Visitor* visitor) = 0;
+    Statement(NodeKind node_kind, SourceLocation loc);
 };
 
 class CompoundStatement : public Statement {
   public:
-    CompoundStatement(std::vector<std::unique_ptr<Statement>> stmts,
-                      SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
+    CompoundStatement(util::Span<Statement*> stmts, SourceLocation loc);
 
-    std::vector<std::unique_ptr<Statement>> stmts;
+    util::Span<Statement*> stmts;
 };
 
 class LetStatement : public Statement {
   public:
-    LetStatement(Type* type, std::string name,
-                 std::unique_ptr<ast::Expression> init_expr,
+    LetStatement(Type* type, Symbol name, ast::Expression* init_expr,
                  SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
 
     Type* type;
-    std::string name;
-    std::unique_ptr<ast::Expression> init_expr;
+    Symbol name;
+    ast::Expression* init_expr;
 };
 
 class ExpressionStatement : public Statement {
 
   public:
-    explicit ExpressionStatement(std::unique_ptr<Expression> expr,
-                                 SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
+    explicit ExpressionStatement(Expression* expr, SourceLocation loc);
 
-    std::unique_ptr<Expression> expr;
+    Expression* expr;
 };
 
 class SelectionStatement : public Statement {
   public:
     SelectionStatement(
-        std::vector<std::pair<std::unique_ptr<Expression>,
-                              std::unique_ptr<CompoundStatement>>> choices,
-        std::unique_ptr<CompoundStatement> else_stmt, SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-
-    std::vector<std::pair<std::unique_ptr<Expression>,
-                          std::unique_ptr<CompoundStatement>>> choices;
-    std::unique_ptr<CompoundStatement> else_stmt;
+        util::Span<std::pair<Expression*, CompoundStatement*>> choices,
+        CompoundStatement* else_stmt, SourceLocation loc);
+
+    util::Span<std::pair<Expression*, CompoundStatement*>> choices;
+    CompoundStatement* else_stmt;
 };
 
 class IterationStatement : public Statement {
   public:
-    IterationStatement(std::unique_ptr<Expression> condition,
-                       std::unique_ptr<CompoundStatement> stmt,
+    IterationStatement(Expression* condition, CompoundStatement* stmt,
                        SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
 
-    std::unique_ptr<Expression> condition;
-    std::unique_ptr<CompoundStatement> stmt;
+    Expression* condition;
+    CompoundStatement* stmt;
 };
 
 class ReturnStatement : public Statement {
   public:
-    explicit ReturnStatement(std::unique_ptr<Expression> expr,
-                             SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
+    explicit ReturnStatement(Expression* expr, SourceLocation loc);
 
-    std::unique_ptr<Expression> expr;
+    Expression* expr;
 };
 
 class Declaration : public Node {
   public:
-    explicit Declaration(SourceLocation loc);
-    virtual void accept(Visitor* visitor) = 0;
+    Declaration(NodeKind node_kind, SourceLocation loc);
 };
 
 class FunctionDeclaration : public Declaration {
   public:
-    FunctionDeclaration(std::string name, FunctionType* type,
-                        SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
+    FunctionDeclaration(Symbol name, FunctionType* type, SourceLocation loc);
 
-    std::string name;
+    Symbol name;
     FunctionType* type;
+
+  protected:
+    FunctionDeclaration(NodeKind node_kind, Symbol name, FunctionType* type,
+                        SourceLocation loc);
 };
 
 class FunctionDefinition : public FunctionDeclaration {
   public:
-    FunctionDefinition(std::string name, FunctionType* type,
-                       std::vector<std::string> param_names,
-                       std::unique_ptr<CompoundStatement> content_stmt,
-                       SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
-
-    std::vector<std::string> param_names;
-    std::unique_ptr<CompoundStatement> content_stmt;
+    FunctionDefinition(Symbol name, FunctionType* type,
+                       util::Span<Symbol> param_names,
+                       CompoundStatement* content_stmt, SourceLocation loc);
+    // body skipped by a lazy parse, loader parses it from the token at
+    // body_token the first time it is asked for
+    FunctionDefinition(Symbol name, FunctionType* type,
+                       util::Span<Symbol> param_names, BodyLoader* loader,
+                       std::uint32_t body_token, SourceLocation loc);
+
+    // the body, parsed by the call after a lazy parse
+    CompoundStatement* content();
+
+    util::Span<Symbol> param_names;
+    CompoundStatement* content_stmt; // null until a lazy body is parsed
+    BodyLoader* loader;
+    std::uint32_t body_token;
 };
 
 class Module : public Declaration {
   public:
-    Module(std::string name,
-           std::vector<std::unique_ptr<Declaration>> declarations,
+    Module(Symbol name, util::Span<Declaration*> declarations,
            SourceLocation loc);
-    virtual void accept(Visitor* visitor) override;
 
-    std::string name;
-    std::vector<std::unique_ptr<Declaration>> declarations;
+    Symbol name;
+    util::Span<Declaration*> declarations;
 };
 
 } // namespace ast
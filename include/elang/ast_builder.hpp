@@ -0,0 +1,157 @@
+#ifndef ELANG_AST_BUILDER_H
+#define ELANG_AST_BUILDER_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <elang/arena.hpp>
+#include <elang/ast.hpp>
+
+namespace elang {
+
+class SourceManager;
+
+namespace ast {
+
+// Parser target building the pointer-linked tree in the compilation unit
+// arena. flat::Builder has the same interface; the begin* calls and the
+// conditions only matter to it.
+class TreeBuilder {
+    util::Arena* _arena;
+
+  public:
+    using Expression = ast::Expression*;
+    using IdentifierReference = ast::IdentifierReference*;
+    using Statement = ast::Statement*;
+    using CompoundStatement = ast::CompoundStatement*;
+    using Declaration = ast::Declaration*;
+    using Module = ast::Module*;
+
+    // absent optional child
+    static constexpr std::nullptr_t none = nullptr;
+    // function bodies can be left to a BodyLoader
+    static constexpr bool lazy_bodies = true;
+
+    // allocates from the arena of sm, or from arena
+    explicit TreeBuilder(SourceManager* sm);
+    explicit TreeBuilder(util::Arena* arena) : _arena(arena) {
+    }
+
+    SourceLocation location(Expression expr) const {
+        return expr->location;
+    }
+
+    Expression binaryOperator(BinaryOperator::Kind kind, Expression lhs,
+                              Expression rhs, SourceLocation loc) {
+        return _arena->make<BinaryOperator>(kind, lhs, rhs, loc);
+    }
+    Expression unaryOperator(UnaryOperator::Kind kind, Expression expr,
+                             SourceLocation loc) {
+        return _arena->make<UnaryOperator>(kind, expr, loc);
+    }
+    Expression subscriptExpression(Expression subscripted, Expression index,
+                                   SourceLocation loc) {
+        return _arena->make<SubscriptExpression>(subscripted, index, loc);
+    }
+    Expression callExpression(IdentifierReference func,
+                              util::Span<const Expression> args,
+                              SourceLocation loc) {
+        return _arena->make<CallExpression>(func, _arena->copy(args), loc);
+    }
+    Expression castExpression(Expression casted, Type* to_type,
+                              SourceLocation loc) {
+        return _arena->make<CastExpression>(casted, to_type, loc);
+    }
+    IdentifierReference
+    identifierReference(Symbol name, util::Span<const Symbol> module_path,
+                        SourceLocation loc) {
+        return _arena->make<ast::IdentifierReference>(
+            name, _arena->copy(module_path), loc);
+    }
+    Expression intLiteral(unsigned long value, SourceLocation loc) {
+        return _arena->make<IntLiteral>(value, loc);
+    }
+    Expression doubleLiteral(double value, SourceLocation loc) {
+        return _arena->make<DoubleLiteral>(value, loc);
+    }
+    Expression charLiteral(char value, SourceLocation loc) {
+        return _arena->make<CharLiteral>(value, loc);
+    }
+    Expression stringLiteral(std::string_view value, SourceLocation loc) {
+        return _arena->make<StringLiteral>(value, loc);
+    }
+    Expression boolLiteral(bool value, SourceLocation loc) {
+        return _arena->make<BoolLiteral>(value, loc);
+    }
+
+    Expression selectionCondition(Expression condition, SourceLocation) {
+        return condition;
+    }
+    Expression iterationCondition(Expression condition, SourceLocation) {
+        return condition;
+    }
+
+    void beginCompoundStatement(SourceLocation) {
+    }
+    CompoundStatement compoundStatement(util::Span<const Statement> stmts,
+                                        SourceLocation loc) {
+        return _arena->make<ast::CompoundStatement>(_arena->copy(stmts), loc);
+    }
+    Statement letStatement(Type* type, Symbol name, Expression init_expr,
+                           SourceLocation loc) {
+        return _arena->make<LetStatement>(type, name, init_expr, loc);
+    }
+    Statement expressionStatement(Expression expr, SourceLocation loc) {
+        return _arena->make<ExpressionStatement>(expr, loc);
+    }
+    Statement selectionStatement(
+        util::Span<const std::pair<Expression, CompoundStatement>> choices,
+        CompoundStatement else_stmt, SourceLocation loc) {
+        return _arena->make<SelectionStatement>(_arena->copy(choices),
+                                                else_stmt, loc);
+    }
+    Statement iterationStatement(Expression condition, CompoundStatement stmt,
+                                 SourceLocation loc) {
+        return _arena->make<IterationStatement>(condition, stmt, loc);
+    }
+    Statement returnStatement(Expression expr, SourceLocation loc) {
+        return _arena->make<ReturnStatement>(expr, loc);
+    }
+
+    Declaration functionDeclaration(Symbol name, FunctionType* type,
+                                    SourceLocation loc) {
+        return _arena->make<FunctionDeclaration>(name, type, loc);
+    }
+    void beginFunctionDefinition(Symbol, FunctionType*,
+                                 util::Span<const Symbol>, SourceLocation) {
+    }
+    Declaration functionDefinition(Symbol name, FunctionType* type,
+                                   util::Span<const Symbol> param_names,
+                                   CompoundStatement content_stmt,
+                                   SourceLocation loc) {
+        return _arena->make<FunctionDefinition>(
+            name, type, _arena->copy(param_names), content_stmt, loc);
+    }
+    Declaration lazyFunctionDefinition(Symbol name, FunctionType* type,
+                                       util::Span<const Symbol> param_names,
+                                       BodyLoader* loader,
+                                       std::size_t body_token,
+                                       SourceLocation loc) {
+        return _arena->make<FunctionDefinition>(
+            name, type, _arena->copy(param_names), loader,
+            static_cast<std::uint32_t>(body_token), loc);
+    }
+    void beginModule(Symbol, SourceLocation) {
+    }
+    Module module(Symbol name, util::Span<const Declaration> declarations,
+                  SourceLocation loc) {
+        return _arena->make<ast::Module>(name, _arena->copy(declarations),
+                                         loc);
+    }
+};
+
+} // namespace ast
+} // namespace elang
+
+#endif // ELANG_AST_BUILDER_H
@@ -6,29 +6,61 @@
 namespace elang {
 namespace ast {
 
-class Visitor {
+// Base of the passes over the tree. dispatch() switches on the node kind
+// and calls the visit overload of Derived for the concrete class, so there
+// is no indirect call and the visits can be inlined into each other.
+// Derived must provide a visit overload for every concrete node class.
+template <class Derived>
+class StaticVisitor {
   public:
-    virtual void visit(BinaryOperator* node) = 0;
-    virtual void visit(UnaryOperator* node) = 0;
-    virtual void visit(SubscriptExpression* node) = 0;
-    virtual void visit(CallExpression* node) = 0;
-    virtual void visit(CastExpression* node) = 0;
-    virtual void visit(LValueToRValueCastExpression* node) = 0;
-    virtual void visit(IdentifierReference* node) = 0;
-    virtual void visit(IntLiteral* node) = 0;
-    virtual void visit(DoubleLiteral* node) = 0;
-    virtual void visit(CharLiteral* node) = 0;
-    virtual void visit(StringLiteral* node) = 0;
-    virtual void visit(BoolLiteral* node) = 0;
-    virtual void visit(CompoundStatement* node) = 0;
-    virtual void visit(LetStatement* node) = 0;
-    virtual void visit(ExpressionStatement* node) = 0;
-    virtual void visit(SelectionStatement* node) = 0;
-    virtual void visit(IterationStatement* node) = 0;
-    virtual void visit(ReturnStatement* node) = 0;
-    virtual void visit(FunctionDeclaration* node) = 0;
-    virtual void visit(FunctionDefinition* node) = 0;
-    virtual void visit(Module* node) = 0;
+    void dispatch(Node* node) {
+        auto self = static_cast<Derived*>(this);
+        switch (node->node_kind) {
+        case NodeKind::BinaryOperator:
+            return self->visit(static_cast<BinaryOperator*>(node));
+        case NodeKind::UnaryOperator:
+            return self->visit(static_cast<UnaryOperator*>(node));
+        case NodeKind::SubscriptExpression:
+            return self->visit(static_cast<SubscriptExpression*>(node));
+        case NodeKind::CallExpression:
+            return self->visit(static_cast<CallExpression*>(node));
+        case NodeKind::CastExpression:
+            return self->visit(static_cast<CastExpression*>(node));
+        case NodeKind::LValueToRValueCastExpression:
+            return self->visit(
+                static_cast<LValueToRValueCastExpression*>(node));
+        case NodeKind::IdentifierReference:
+            return self->visit(static_cast<IdentifierReference*>(node));
+        case NodeKind::IntLiteral:
+            return self->visit(static_cast<IntLiteral*>(node));
+        case NodeKind::DoubleLiteral:
+            return self->visit(static_cast<DoubleLiteral*>(node));
+        case NodeKind::CharLiteral:
+            return self->visit(static_cast<CharLiteral*>(node));
+        case NodeKind::StringLiteral:
+            return self->visit(static_cast<StringLiteral*>(node));
+        case NodeKind::BoolLiteral:
+            return self->visit(static_cast<BoolLiteral*>(node));
+        case NodeKind::CompoundStatement:
+            return self->visit(static_cast<CompoundStatement*>(node));
+        case NodeKind::LetStatement:
+            return self->visit(static_cast<LetStatement*>(node));
+        case NodeKind::ExpressionStatement:
+            return self->visit(static_cast<ExpressionStatement*>(node));
+        case NodeKind::SelectionStatement:
+            return self->visit(static_cast<SelectionStatement*>(node));
+        case NodeKind::IterationStatement:
+            return self->visit(static_cast<IterationStatement*>(node));
+        case NodeKind::ReturnStatement:
+            return self->visit(static_cast<ReturnStatement*>(node));
+        case NodeKind::FunctionDeclaration:
+            return self->visit(static_cast<FunctionDeclaration*>(node));
+        case NodeKind::FunctionDefinition:
+            return self->visit(static_cast<FunctionDefinition*>(node));
+        case NodeKind::Module:
+            return self->visit(static_cast<Module*>(node));
+        }
+    }
 };
 
 } // namespace ast
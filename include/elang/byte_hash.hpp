@@ -0,0 +1,23 @@
+#ifndef ELANG_BYTE_HASH_H
+#define ELANG_BYTE_HASH_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace elang {
+namespace util {
+
+// Hash of bytes read 8 at a time, continuing from hash. It is the same from
+// one run to the next on machines of the same byte order, so files holding
+// one must check that order too.
+std::uint64_t hashBytes(std::uint64_t hash, const void* data,
+                        std::size_t size);
+
+inline std::uint64_t hashBytes(std::uint64_t hash, std::string_view str) {
+    return hashBytes(hash, str.data(), str.size());
+}
+
+} // namespace util
+} // namespace elang
+
+#endif // ELANG_BYTE_HASH_H
@@ -0,0 +1,38 @@
+#ifndef ELANG_CHAR_SCAN_H
+#define ELANG_CHAR_SCAN_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace elang {
+namespace util {
+
+// appends to line_starts the offset of the first character of every line
+// in buffer (0 included)
+void collectLineStarts(std::string_view buffer,
+                       std::vector<std::uint32_t>& line_starts);
+
+// Lexer scanners: each one returns the length of the longest prefix of
+// [data, data + size) made of the characters it skips.
+//
+// The vectorized implementations are picked at startup from what the CPU
+// supports, and all of them return the same results as the scalar one.
+enum class ScanImpl { Scalar, SSE2, AVX2 };
+
+bool isScanImplSupported(ScanImpl impl);
+ScanImpl getScanImpl();
+void setScanImpl(ScanImpl impl); // impl must be supported
+const char* scanImplName(ScanImpl impl);
+
+// ' ', '\n', '\t' and '\r'
+std::size_t skipWhiteSpaces(const char* data, std::size_t size);
+// anything but '\n'
+std::size_t skipToNewline(const char* data, std::size_t size);
+// [a-zA-Z0-9_]
+std::size_t skipIdentifierChars(const char* data, std::size_t size);
+
+} // namespace util
+} // namespace elang
+
+#endif // ELANG_CHAR_SCAN_H
@@ -4,35 +4,45 @@
 #include <elang/ast_visitor.hpp>
 
 namespace elang {
+
+class SourceManager;
+class StringInterner;
+
 namespace ast {
 
-class DebugVisitor : public Visitor {
+class DebugVisitor : public StaticVisitor<DebugVisitor> {
+    StringInterner* _interner;
+    bool _print_bodies;
     std::string current_tab;
     void increaseTab();
     void decreaseTab();
 
   public:
-    virtual void visit(BinaryOperator* node) override;
-    virtual void visit(UnaryOperator* node) override;
-    virtual void visit(SubscriptExpression* node) override;
-    virtual void visit(CallExpression* node) override;
-    virtual void visit(CastExpression* node) override;
-    virtual void visit(LValueToRValueCastExpression* node) override;
-    virtual void visit(IdentifierReference* node) override;
-    virtual void visit(IntLiteral* node) override;
-    virtual void visit(DoubleLiteral* node) override;
-    virtual void visit(CharLiteral* node) override;
-    virtual void visit(StringLiteral* node) override;
-    virtual void visit(BoolLiteral* node) override;
-    virtual void visit(CompoundStatement* node) override;
-    virtual void visit(LetStatement* node) override;
-    virtual void visit(ExpressionStatement* node) override;
-    virtual void visit(SelectionStatement* node) override;
-    virtual void visit(IterationStatement* node) override;
-    virtual void visit(ReturnStatement* node) override;
-    virtual void visit(FunctionDeclaration* node) override;
-    virtual void visit(FunctionDefinition* node) override;
-    virtual void visit(Module* node) override;
+    // without the bodies, only the signatures of the definitions are
+    // printed, and lazy bodies are never parsed
+    explicit DebugVisitor(SourceManager* sm, bool print_bodies = true);
+
+    void visit(BinaryOperator* node);
+    void visit(UnaryOperator* node);
+    void visit(SubscriptExpression* node);
+    void visit(CallExpression* node);
+    void visit(CastExpression* node);
+    void visit(LValueToRValueCastExpression* node);
+    void visit(IdentifierReference* node);
+    void visit(IntLiteral* node);
+    void visit(DoubleLiteral* node);
+    void visit(CharLiteral* node);
+    void visit(StringLiteral* node);
+    void visit(BoolLiteral* node);
+    void visit(CompoundStatement* node);
+    void visit(LetStatement* node);
+    void visit(ExpressionStatement* node);
+    void visit(SelectionStatement* node);
+    void visit(IterationStatement* node);
+    void visit(ReturnStatement* node);
+    void visit(FunctionDeclaration* node);
+    void visit(FunctionDefinition* node);
+    void visit(Module* node);
 };
 
 } // namespace ast
@@ -1,6 +1,7 @@
 #ifndef ELANG_DIAGNOSTIC_H
 #define ELANG_DIAGNOSTIC_H
 
+#include <exception>
 #include <string>
 #include <vector>
 
@@ -11,6 +12,37 @@ namespace elang {
 class SourceManager;
 
 class DiagnosticEngine {
+  public:
+    struct Diagnostic {
+        SourceLocation location;
+        unsigned error_index;
+        std::vector<std::string> params;
+    };
+
+    // thrown by report once a capture with a limit is full
+    class CaptureAborted : public std::exception {
+      public:
+        const char* what() const noexcept override {
+            return "diagnostic capture aborted";
+        }
+    };
+
+    // While alive, the diagnostics reported from the current thread are
+    // appended to the sink instead of being printed, and never abort the
+    // compilation. Captures nest. With a limit, the report that fills the
+    // sink up to it throws CaptureAborted, where a compilation would stop.
+    class Capture {
+        std::vector<Diagnostic>* _previous;
+        unsigned _previous_limit;
+
+      public:
+        explicit Capture(std::vector<Diagnostic>* sink, unsigned limit = 0);
+        ~Capture();
+        Capture(const Capture&) = delete;
+        Capture& operator=(const Capture&) = delete;
+    };
+
+  private:
     SourceManager* _source_manager;
     unsigned _limit;
     unsigned _nerr;
@@ -22,12 +54,14 @@ class DiagnosticEngine {
 
     template <class... Ts>
     void report(SourceLocation loc, unsigned error_index, Ts... params) {
-        return report(loc, error_index, {params...});
+        return report(Diagnostic{loc, error_index, {std::string(params)...}});
     }
 
+    // reports diagnostics captured earlier, in order
+    void report(const std::vector<Diagnostic>& diagnostics);
+
   private:
-    void report(SourceLocation loc, unsigned error_index,
-                std::initializer_list<std::string> params);
+    void report(Diagnostic diagnostic);
 };
 
 } // namespace elang
@@ -0,0 +1,426 @@
+#ifndef ELANG_FLAT_AST_H
+#define ELANG_FLAT_AST_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <elang/arena.hpp>
+#include <elang/ast.hpp>
+#include <elang/mapped_file.hpp>
+#include <elang/source_location.hpp>
+#include <elang/string_interner.hpp>
+
+namespace elang {
+
+class SourceManager;
+class Type;
+class FunctionType;
+
+// Alternative AST representation: every node is an entry in one array, in
+// post-order, and refers to its children by 32 bits index. What a node
+// holds besides its kind lives in one array per kind. Passes can walk the
+// nodes linearly instead of chasing pointers.
+//
+// Modules, function definitions and compound statements also get a begin
+// node ahead of their content, so that a linear pass can open their scope
+// (or skip over them). The conditions of if and while statements get a
+// node of their own right before the statement they guard.
+//
+// Nothing in the arrays is a pointer: types are indices in a table of the
+// tree and string literals are ranges of its chars, so that the arrays can
+// be written to a file as they are and used in place once mapped back.
+namespace flat {
+
+using NodeIndex = std::uint32_t;
+using TypeIndex = std::uint32_t;
+
+constexpr NodeIndex no_node = ~NodeIndex{0};
+constexpr TypeIndex no_type = ~TypeIndex{0};
+
+// elements [begin, begin + size) of one of the Tree lists
+struct List {
+    std::uint32_t begin;
+    std::uint32_t size;
+};
+
+enum class NodeKind : std::uint8_t {
+    BinaryOperator,
+    UnaryOperator,
+    SubscriptExpression,
+    CallExpression,
+    CastExpression,
+    IdentifierReference,
+    IntLiteral,
+    DoubleLiteral,
+    CharLiteral,
+    StringLiteral,
+    BoolLiteral,
+    SelectionCondition,
+    IterationCondition,
+    BlockBegin,
+    CompoundStatement,
+    LetStatement,
+    ExpressionStatement,
+    SelectionStatement,
+    IterationStatement,
+    ReturnStatement,
+    FunctionDeclaration,
+    FunctionBegin,
+    FunctionDefinition,
+    ModuleBegin,
+    Module
+};
+
+struct BinaryOperator {
+    ast::BinaryOperator::Kind kind;
+    NodeIndex lhs;
+    NodeIndex rhs;
+};
+
+struct UnaryOperator {
+    ast::UnaryOperator::Kind kind;
+    NodeIndex expr;
+};
+
+struct SubscriptExpression {
+    NodeIndex subscripted;
+    NodeIndex index;
+};
+
+struct CallExpression {
+    NodeIndex func;
+    List args; // nodes
+};
+
+struct CastExpression {
+    NodeIndex casted;
+    TypeIndex to_type;
+};
+
+struct IdentifierReference {
+    Symbol name;
+    List module_path; // symbols
+};
+
+// selection and iteration conditions
+struct Condition {
+    NodeIndex expr;
+};
+
+struct BlockBegin {
+    NodeIndex end;
+};
+
+struct CompoundStatement {
+    NodeIndex begin;
+    List stmts; // nodes
+};
+
+struct LetStatement {
+    TypeIndex type; // no_type when inferred
+    Symbol name;
+    NodeIndex init_expr; // no_node without initializer
+};
+
+struct ExpressionStatement {
+    NodeIndex expr; // no_node for an empty statement
+};
+
+struct SelectionStatement {
+    List choices; // nodes, condition and compound statement pairs
+    NodeIndex else_stmt; // no_node without else
+};
+
+struct IterationStatement {
+    NodeIndex condition;
+    NodeIndex stmt;
+};
+
+struct ReturnStatement {
+    NodeIndex expr; // no_node for a bare return
+};
+
+struct FunctionDeclaration {
+    Symbol name;
+    TypeIndex type; // a function type
+};
+
+struct FunctionBegin {
+    Symbol name;
+    TypeIndex type; // a function type
+    List param_names; // symbols
+    NodeIndex end;
+};
+
+struct FunctionDefinition {
+    NodeIndex begin;
+    NodeIndex content_stmt;
+};
+
+struct ModuleBegin {
+    Symbol name;
+    NodeIndex end;
+};
+
+struct Module {
+    NodeIndex begin;
+    List declarations; // nodes
+};
+
+struct NodeEntry {
+    NodeKind kind;
+    std::uint32_t payload; // index in the array of its kind
+};
+
+// storage of the arrays of a tree built in memory
+struct TreeArrays {
+#define FLAT_ARRAY(T, name) std::vector<T> name;
+#include <elang/flat_arrays.def>
+};
+
+class Tree {
+    // views over _arrays, or over _mapping for a tree read from a file
+#define FLAT_ARRAY(T, name) util::Span<const T> _##name;
+#include <elang/flat_arrays.def>
+
+    std::unique_ptr<TreeArrays> _arrays;
+    util::MappedFile _mapping;
+
+    std::vector<Type*> _type_table; // what the TypeIndex refer to
+    std::vector<Type*> _types;      // filled by sema
+
+    NodeIndex _root{no_node};
+
+  public:
+    Tree() = default;
+    Tree(Tree&&) = default;
+    Tree& operator=(Tree&&) = default;
+
+    NodeIndex size() const {
+        return static_cast<NodeIndex>(_nodes.size());
+    }
+    // the main module, last node of the tree
+    NodeIndex root() const {
+        return _root;
+    }
+
+    NodeKind kind(NodeIndex node) const {
+        return _nodes[node].kind;
+    }
+    SourceLocation location(NodeIndex node) const {
+        return _locations[node];
+    }
+    Type* type(NodeIndex node) const {
+        return _types[node];
+    }
+    void setType(NodeIndex node, Type* type) {
+        _types[node] = type;
+    }
+    // type a payload refers to, null for no_type
+    Type* typeAt(TypeIndex index) const {
+        return index == no_type ? nullptr : _type_table[index];
+    }
+
+    util::Span<const NodeIndex> nodes(List list) const {
+        return {_node_lists.begin() + list.begin, list.size};
+    }
+    util::Span<const Symbol> symbols(List list) const {
+        return {_symbol_lists.begin() + list.begin, list.size};
+    }
+
+    // payload of a node, which must be of the matching kind
+    const BinaryOperator& binaryOperator(NodeIndex node) const {
+        return _binary_operators[_nodes[node].payload];
+    }
+    const UnaryOperator& unaryOperator(NodeIndex node) const {
+        return _unary_operators[_nodes[node].payload];
+    }
+    const SubscriptExpression& subscriptExpression(NodeIndex node) const {
+        return _subscript_expressions[_nodes[node].payload];
+    }
+    const CallExpression& callExpression(NodeIndex node) const {
+        return _call_expressions[_nodes[node].payload];
+    }
+    const CastExpression& castExpression(NodeIndex node) const {
+        return _cast_expressions[_nodes[node].payload];
+    }
+    const IdentifierReference& identifierReference(NodeIndex node) const {
+        return _identifier_references[_nodes[node].payload];
+    }
+    std::uint64_t intLiteral(NodeIndex node) const {
+        return _int_literals[_nodes[node].payload];
+    }
+    double doubleLiteral(NodeIndex node) const {
+        return _double_literals[_nodes[node].payload];
+    }
+    char charLiteral(NodeIndex node) const {
+        return _char_literals[_nodes[node].payload];
+    }
+    std::string_view stringLiteral(NodeIndex node) const {
+        auto chars = _string_literals[_nodes[node].payload];
+        return {_chars.begin() + chars.begin, chars.size};
+    }
+    bool boolLiteral(NodeIndex node) const {
+        return _bool_literals[_nodes[node].payload] != 0;
+    }
+    const Condition& condition(NodeIndex node) const {
+        return _conditions[_nodes[node].payload];
+    }
+    const BlockBegin& blockBegin(NodeIndex node) const {
+        return _block_begins[_nodes[node].payload];
+    }
+    const CompoundStatement& compoundStatement(NodeIndex node) const {
+        return _compound_statements[_nodes[node].payload];
+    }
+    const LetStatement& letStatement(NodeIndex node) const {
+        return _let_statements[_nodes[node].payload];
+    }
+    const ExpressionStatement& expressionStatement(NodeIndex node) const {
+        return _expression_statements[_nodes[node].payload];
+    }
+    const SelectionStatement& selectionStatement(NodeIndex node) const {
+        return _selection_statements[_nodes[node].payload];
+    }
+    const IterationStatement& iterationStatement(NodeIndex node) const {
+        return _iteration_statements[_nodes[node].payload];
+    }
+    const ReturnStatement& returnStatement(NodeIndex node) const {
+        return _return_statements[_nodes[node].payload];
+    }
+    const FunctionDeclaration& functionDeclaration(NodeIndex node) const {
+        return _function_declarations[_nodes[node].payload];
+    }
+    const FunctionBegin& functionBegin(NodeIndex node) const {
+        return _function_begins[_nodes[node].payload];
+    }
+    const FunctionDefinition& functionDefinition(NodeIndex node) const {
+        return _function_definitions[_nodes[node].payload];
+    }
+    const ModuleBegin& moduleBegin(NodeIndex node) const {
+        return _module_begins[_nodes[node].payload];
+    }
+    const Module& module(NodeIndex node) const {
+        return _modules[_nodes[node].payload];
+    }
+
+    // memory held by the arrays
+    std::size_t bytesUsed() const;
+
+    friend class Builder;
+    friend void writeBinaryTree(const Tree& tree, SourceManager* sm,
+                                std::ostream& out);
+    friend Tree readBinaryTree(const std::string& file_path,
+                               SourceManager* sm);
+};
+
+// Parser target building a Tree, see ast::TreeBuilder for the interface
+class Builder {
+    std::unique_ptr<TreeArrays> _arrays;
+    std::vector<Type*> _type_table;
+    std::unordered_map<Type*, TypeIndex> _type_indices;
+    std::vector<NodeIndex> _open_begins; // waiting for their end node
+
+  public:
+    using Expression = NodeIndex;
+    using IdentifierReference = NodeIndex;
+    using Statement = NodeIndex;
+    using CompoundStatement = NodeIndex;
+    using Declaration = NodeIndex;
+    using Module = NodeIndex;
+
+    // absent optional child
+    static constexpr NodeIndex none = no_node;
+    // nodes are numbered in tree order, every body is parsed in place
+    static constexpr bool lazy_bodies = false;
+
+    explicit Builder(SourceManager* sm);
+
+    // there are a bit fewer nodes than tokens in practice
+    void reserve(std::size_t tokens);
+
+    SourceLocation location(NodeIndex node) const {
+        return _arrays->locations[node];
+    }
+
+    NodeIndex binaryOperator(ast::BinaryOperator::Kind kind, NodeIndex lhs,
+                             NodeIndex rhs, SourceLocation loc);
+    NodeIndex unaryOperator(ast::UnaryOperator::Kind kind, NodeIndex expr,
+                            SourceLocation loc);
+    NodeIndex subscriptExpression(NodeIndex subscripted, NodeIndex index,
+                                  SourceLocation loc);
+    NodeIndex callExpression(NodeIndex func, util::Span<const NodeIndex> args,
+                             SourceLocation loc);
+    NodeIndex castExpression(NodeIndex casted, Type* to_type,
+                             SourceLocation loc);
+    NodeIndex identifierReference(Symbol name,
+                                  util::Span<const Symbol> module_path,
+                                  SourceLocation loc);
+    NodeIndex intLiteral(unsigned long value, SourceLocation loc);
+    NodeIndex doubleLiteral(double value, SourceLocation loc);
+    NodeIndex charLiteral(char value, SourceLocation loc);
+    NodeIndex stringLiteral(std::string_view value, SourceLocation loc);
+    NodeIndex boolLiteral(bool value, SourceLocation loc);
+
+    // loc is the one of the if or while statement
+    NodeIndex selectionCondition(NodeIndex condition, SourceLocation loc);
+    NodeIndex iterationCondition(NodeIndex condition, SourceLocation loc);
+
+    void beginCompoundStatement(SourceLocation loc);
+    NodeIndex compoundStatement(util::Span<const NodeIndex> stmts,
+                                SourceLocation loc);
+    NodeIndex letStatement(Type* type, Symbol name, NodeIndex init_expr,
+                           SourceLocation loc);
+    NodeIndex expressionStatement(NodeIndex expr, SourceLocation loc);
+    NodeIndex selectionStatement(
+        util::Span<const std::pair<NodeIndex, NodeIndex>> choices,
+        NodeIndex else_stmt, SourceLocation loc);
+    NodeIndex iterationStatement(NodeIndex condition, NodeIndex stmt,
+                                 SourceLocation loc);
+    NodeIndex returnStatement(NodeIndex expr, SourceLocation loc);
+
+    NodeIndex functionDeclaration(Symbol name, FunctionType* type,
+                                  SourceLocation loc);
+    void beginFunctionDefinition(Symbol name, FunctionType* type,
+                                 util::Span<const Symbol> param_names,
+                                 SourceLocation loc);
+    NodeIndex functionDefinition(Symbol name, FunctionType* type,
+                                 util::Span<const Symbol> param_names,
+                                 NodeIndex content_stmt, SourceLocation loc);
+    void beginModule(Symbol name, SourceLocation loc);
+    NodeIndex module(Symbol name, util::Span<const NodeIndex> declarations,
+                     SourceLocation loc);
+
+    // hands the tree over, root being the main module
+    Tree finish(NodeIndex root);
+
+  private:
+    template <class T>
+    NodeIndex add(NodeKind kind, std::vector<T>& payloads, T payload,
+                  SourceLocation loc) {
+        auto node = static_cast<NodeIndex>(_arrays->nodes.size());
+        _arrays->nodes.push_back(
+            {kind, static_cast<std::uint32_t>(payloads.size())});
+        _arrays->locations.push_back(loc);
+        payloads.push_back(std::move(payload));
+        return node;
+    }
+
+    // the innermost open begin node, now ended by the next node
+    NodeIndex closeBegin();
+
+    // index of type in the table, after the types it is made of
+    TypeIndex addType(Type* type);
+    List addNodes(util::Span<const NodeIndex> nodes);
+    List addSymbols(util::Span<const Symbol> symbols);
+};
+
+} // namespace flat
+} // namespace elang
+
+#endif // ELANG_FLAT_AST_H
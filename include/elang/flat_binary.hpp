@@ -0,0 +1,38 @@
+#ifndef ELANG_FLAT_BINARY_H
+#define ELANG_FLAT_BINARY_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include <elang/flat_ast.hpp>
+
+namespace elang {
+
+class SourceManager;
+
+namespace flat {
+
+// Binary tree files hold the arrays of a flat::Tree as they are in memory,
+// so that reading one back maps the file and points the tree at it instead
+// of decoding every node. Symbols and types are process-wide, they are
+// written as the strings of the interner and as type records, and rebuilt
+// when the file is read.
+//
+// A file is only readable by a build with the same version and the same
+// layout of the arrays; anything else is rejected, not converted.
+constexpr std::uint32_t binary_tree_version = 2;
+
+// writes tree, made from a single source file of sm, as it is produced
+void writeBinaryTree(const Tree& tree, SourceManager* sm, std::ostream& out);
+
+// Maps a file written by writeBinaryTree and registers its source file in
+// sm, which must not have interned anything yet since the symbols of the
+// tree must keep their ids. Throws std::runtime_error when the file can't
+// be used, or when its source file changed since it was written.
+Tree readBinaryTree(const std::string& file_path, SourceManager* sm);
+
+} // namespace flat
+} // namespace elang
+
+#endif // ELANG_FLAT_BINARY_H
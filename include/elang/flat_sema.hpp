@@ -0,0 +1,83 @@
+#ifndef ELANG_FLAT_SEMA_H
+#define ELANG_FLAT_SEMA_H
+
+#include <vector>
+
+#include <elang/flat_ast.hpp>
+#include <elang/op_inferer.hpp>
+#include <elang/parallel_sema.hpp>
+#include <elang/symbol_table.hpp>
+
+namespace elang {
+
+class SourceManager;
+class TypeManager;
+class Type;
+class DiagnosticEngine;
+class StringInterner;
+
+namespace flat {
+
+// Same checks as ast::SemaVisitor, in the same two phases: a walk over the
+// module and function nodes, then one over the nodes of each function body
+// in tree order. Lvalue to rvalue conversions aren't materialized: the type of
+// a node stays the one of its value category, and its users convert it.
+class Sema {
+    // a body left for the second phase
+    struct PendingBody {
+        NodeIndex begin; // its FunctionBegin
+        GlobalTable::ModuleId module;
+    };
+
+    TypeManager* _type_manager;
+    DiagnosticEngine* _diag_engine;
+    StringInterner* _interner;
+    OpInferer _op_inferer;
+    LocalTable _local_table; // reset for each function
+    GlobalTable _global_table; // filled by the first phase
+    const GlobalTable* _globals; // see ast::SemaVisitor
+    std::vector<PendingBody> _pending;
+    SemaBodies _bodies;
+
+    GlobalTable::ModuleId _current_module;
+    Type* _current_return_ty;
+    Tree* _tree;
+
+    // scratch buffers, kept to reuse their storage
+    std::vector<Type*> _args_ty;
+
+  public:
+    explicit Sema(SourceManager* sm);
+    Sema(const Sema&) = delete;
+    Sema& operator=(const Sema&) = delete;
+
+    // as ast::SemaVisitor::check
+    void check(Tree* tree, unsigned jobs = 1);
+
+  private:
+    // for the bodies checked on another thread
+    Sema(const Sema& parent, Tree* tree);
+
+    void checkBody(const PendingBody& body);
+    void checkNode(NodeIndex node);
+
+    // type of the node once converted to an rvalue
+    Type* rvalueType(NodeIndex node);
+
+    void checkBinaryOperator(NodeIndex node);
+    void checkUnaryOperator(NodeIndex node);
+    void checkSubscriptExpression(NodeIndex node);
+    void checkCallExpression(NodeIndex node);
+    void checkCastExpression(NodeIndex node);
+    void checkIdentifierReference(NodeIndex node);
+    void checkLetStatement(NodeIndex node);
+    void checkReturnStatement(NodeIndex node);
+    void checkFunctionDeclaration(NodeIndex node);
+    // queues the body unless the function is rejected
+    void checkFunctionBegin(NodeIndex node);
+};
+
+} // namespace flat
+} // namespace elang
+
+#endif // ELANG_FLAT_SEMA_H
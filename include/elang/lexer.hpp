@@ -2,7 +2,8 @@
 #define ELANG_LEXER_H
 
 #include <string>
-#include <stack>
+#include <string_view>
+#include <vector>
 
 #include <elang/source_reader.hpp>
 #include <elang/token.hpp>
@@ -11,28 +12,44 @@ namespace elang {
 
 class SourceManager;
 class DiagnosticEngine;
+class StringInterner;
 
 class Lexer {
+  public:
+    // Defer leaves the identifiers without symbol and makes the data of
+    // the decoded literals an index in decodedLiterals(), for lexers that
+    // must not touch the interner
+    enum class Symbols { Intern, Defer };
+
+  private:
     SourceManager* _source_manager;
     DiagnosticEngine* _diag_engine;
+    StringInterner* _interner; // null when the symbols are deferred
     SourceReader _reader;
-    std::stack<Token> _waiting_tokens;
+    std::vector<std::string> _decoded_literals;
 
   public:
     explicit Lexer(SourceManager* source_manager, unsigned fileid);
-    Token peekToken();
+    // starts lexing at offset, which must not be inside a token
+    Lexer(SourceManager* source_manager, unsigned fileid, std::size_t offset,
+          Symbols symbols);
     Token getToken();
 
-  private:
-    bool matchChar(int expected);
-    Token::Kind twoCharTokenKind(int expected, Token::Kind tk1,
-                                 Token::Kind tk2);
+    const std::vector<std::string>& decodedLiterals() const {
+        return _decoded_literals;
+    }
 
+  private:
     void eatWhiteSpaces();
-    std::string readIdentifierOrKeyword();
-    std::string readNumber();
+    std::string_view readIdentifierOrKeyword();
+    void readNumber();
     char readLiteralChar();
     void readComment();
+    std::uint32_t addDecodedLiteral(std::string_view literal);
+    Token makeToken(Token::Kind kind, SourceLocation loc);
+    Token makePunctuatorToken(int first, SourceLocation loc);
+    Token makeStringLiteralToken(SourceLocation loc);
+    Token makeCharLiteralToken(SourceLocation loc);
     Token makeIdentiferOrKeywordToken();
     Token makeIntegerOrDoubleLiteralToken();
 };
@@ -0,0 +1,42 @@
+#ifndef ELANG_MAPPED_FILE_H
+#define ELANG_MAPPED_FILE_H
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+namespace elang {
+namespace util {
+
+// read-only memory mapping of a whole file, unmapped on destruction
+class MappedFile {
+    const char* _data;
+    std::size_t _size;
+
+  public:
+    MappedFile();
+    explicit MappedFile(const std::string& file_path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // false for files that can't be mapped (empty files, pipes, ...)
+    bool isMapped() const noexcept {
+        return _data != nullptr;
+    }
+
+    std::string_view view() const noexcept {
+        return {_data, _size};
+    }
+
+  private:
+    void unmap();
+};
+
+} // namespace util
+} // namespace elang
+
+#endif // ELANG_MAPPED_FILE_H
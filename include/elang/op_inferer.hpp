@@ -1,26 +1,37 @@
 #ifndef ELANG_OP_INFERER_H
 #define ELANG_OP_INFERER_H
 
+#include <elang/ast.hpp>
+
 namespace elang {
 
 class TypeManager;
 class Type;
 
+// Types the operators from tables indexed by the operator and the classes
+// of its operands, see op_inferer.cpp, instead of comparing the operands
+// against every type the operator accepts.
 class OpInferer {
     TypeManager* _type_manager;
 
   public:
+    // the type of an operator, or the error to report and the type to go
+    // on with when its operands don't fit
+    struct Inferred {
+        Type* type;
+        bool failed;
+        unsigned error; // when failed
+    };
+
     OpInferer(TypeManager* tm);
-    Type* inferBinaryAddOrMinus(Type* lhs_ty, Type* rhs_ty);
-    Type* inferBinaryTimesOrDivide(Type* lhs_ty, Type* rhs_ty);
-    Type* inferBinaryModulo(Type* lhs_ty, Type* rhs_ty);
-    Type* inferBinaryEqualOrDifferent(Type* lhs_ty, Type* rhs_ty);
-    Type* inferBinaryComp(Type* lhs_ty, Type* rhs_ty);
-    Type* inferBinaryAndOrOr(Type* lhs_ty, Type* rhs_ty);
-
-    Type* inferUnaryPlusOrMinus(Type* ty);
-    Type* inferUnaryNot(Type* ty);
-    Type* inferUnaryPtrDeref(Type* ty);
+
+    // op is not Assign
+    Inferred inferBinary(ast::BinaryOperator::Kind op, Type* lhs_ty,
+                         Type* rhs_ty) const;
+    // op is not AddressOf
+    Inferred inferUnary(ast::UnaryOperator::Kind op, Type* ty) const;
+    // whether a value of type ty can be cast to to_ty
+    bool canCast(Type* ty, Type* to_ty) const;
 };
 
 } // namespace elang
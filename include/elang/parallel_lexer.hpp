@@ -0,0 +1,28 @@
+#ifndef ELANG_PARALLEL_LEXER_H
+#define ELANG_PARALLEL_LEXER_H
+
+#include <cstddef>
+
+namespace elang {
+
+class SourceManager;
+class TokenBuffer;
+
+// Lexes a whole file into tokens with up to jobs threads, exactly as the
+// serial lexer would: same tokens, same symbols, and the same diagnostics
+// reported in the same order.
+//
+// The buffer is cut into chunks at newlines and every chunk is lexed on
+// its own as if it started between two tokens. A chunk starting inside a
+// string literal or a comment gets wrong tokens until it falls back in
+// step with the real token boundaries, so the chunks are stitched on the
+// first token of the next chunk that starts where the previous chunk
+// stopped, and re-lexed serially when there is none. Chunks are at least
+// min_chunk_size bytes long.
+void lexInParallel(SourceManager* source_manager, unsigned fileid,
+                   unsigned jobs, TokenBuffer* tokens,
+                   std::size_t min_chunk_size = 256 * 1024);
+
+} // namespace elang
+
+#endif // ELANG_PARALLEL_LEXER_H
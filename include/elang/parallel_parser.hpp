@@ -0,0 +1,32 @@
+#ifndef ELANG_PARALLEL_PARSER_H
+#define ELANG_PARALLEL_PARSER_H
+
+namespace elang {
+
+class SourceManager;
+class TokenBuffer;
+
+namespace ast {
+class Module;
+}
+
+// Parses the main module with the function bodies parsed up front on up to
+// jobs threads, and gives the same tree and the same diagnostics, in the
+// same order, as Parser::parseMainModule on these tokens. tokens must hold
+// the whole file, as in Eager mode or after lexInParallel.
+//
+// A pre-pass matches the braces on the token stream to find the bodies.
+// Each one is parsed from its own copy of its tokens into an arena of the
+// thread, then the serial parse of the file takes the bodies in place of
+// parsing them. A body that reported diagnostics is dropped: an error
+// recovery can read past its closing brace, so the serial parse goes
+// through it again and reports them in order.
+//
+// jobs is capped by the cores of the machine and by the number of bodies,
+// and the file is parsed serially when that leaves a single thread.
+ast::Module* parseInParallel(TokenBuffer* tokens, SourceManager* source_manager,
+                             unsigned jobs);
+
+} // namespace elang
+
+#endif // ELANG_PARALLEL_PARSER_H
@@ -0,0 +1,57 @@
+#ifndef ELANG_PARALLEL_SEMA_H
+#define ELANG_PARALLEL_SEMA_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <elang/diagnostic.hpp>
+
+namespace elang {
+
+// Function bodies left by the walk of sema over the declarations, checked
+// once the walk is done, on one thread or several, with the diagnostics
+// reported in the order a single walk over everything would have given.
+//
+// The walk runs under a capture of declarationSink() and calls addBody()
+// where each body comes, check() runs the checks of the bodies under
+// captures of their own, and report() merges all of them.
+class SemaBodies {
+    using Diagnostic = DiagnosticEngine::Diagnostic;
+
+    struct Body {
+        // diagnostics of the walk that come before the body
+        std::size_t declarations_before;
+        std::vector<Diagnostic> diagnostics;
+    };
+
+    std::vector<Diagnostic> _declaration_diagnostics;
+    std::vector<Body> _bodies;
+
+  public:
+    std::vector<Diagnostic>* declarationSink() {
+        return &_declaration_diagnostics;
+    }
+
+    // index of the new body
+    std::size_t addBody();
+    std::size_t size() const {
+        return _bodies.size();
+    }
+
+    // threads check() will use for jobs: no more than there are batches of
+    // bodies, and at least one
+    unsigned threads(unsigned jobs) const;
+
+    // Calls check_body(thread, body) for every body, from threads threads
+    // numbered from 0, the calling one being 0. A thread takes consecutive
+    // bodies by batches and checks them one at a time.
+    void check(unsigned threads,
+               const std::function<void(unsigned, std::size_t)>& check_body);
+
+    void report(DiagnosticEngine* diag_engine);
+};
+
+} // namespace elang
+
+#endif // ELANG_PARALLEL_SEMA_H
@@ -1,59 +1,148 @@
 #ifndef ELANG_PARSER_H
 #define ELANG_PARSER_H
 
-#include <memory>
+#include <cstddef>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-#include <elang/ast.hpp>
+#include <elang/ast_builder.hpp>
+#include <elang/flat_ast.hpp>
+#include <elang/scratch_stack.hpp>
 #include <elang/type.hpp>
 #include <elang/token.hpp>
 
 namespace elang {
 
-class Lexer;
+class TokenBuffer;
 class SourceManager;
 class DiagnosticEngine;
+class BodyLoader;
 
-class Parser {
-    Lexer* _lexer;
+// Builder decides what the parser produces: ast::TreeBuilder for the
+// pointer-linked tree, flat::Builder for a flat::Tree
+template <class Builder>
+class BasicParser {
+    using Expression = typename Builder::Expression;
+    using IdentifierReference = typename Builder::IdentifierReference;
+    using Statement = typename Builder::Statement;
+    using CompoundStatement = typename Builder::CompoundStatement;
+    using Declaration = typename Builder::Declaration;
+    using Module = typename Builder::Module;
+
+  public:
+    // A function body parsed ahead of time: when a function body starts at
+    // the token begin, the parser takes body and goes on from the token end.
+    struct PreparsedBody {
+        std::size_t begin;
+        std::size_t end;
+        CompoundStatement body;
+    };
+
+  private:
+    TokenBuffer* _tokens;
+    SourceManager* _source_manager;
     TypeManager* _type_manager;
     DiagnosticEngine* _diag_engine;
+    Builder _builder;
+
+    const std::vector<PreparsedBody>* _preparsed; // sorted by begin
+    std::size_t _next_preparsed;
+    BodyLoader* _body_loader;
+
+    // the lists being parsed, kept from one to the next
+    util::ScratchStack<Declaration> _declarations;
+    util::ScratchStack<Statement> _statements;
+    util::ScratchStack<std::pair<Expression, CompoundStatement>> _choices;
+    util::ScratchStack<Expression> _args;
+    util::ScratchStack<Symbol> _symbols; // module paths and parameter names
+    util::ScratchStack<Type*> _param_types;
 
   public:
-    Parser(Lexer* lexer, SourceManager* sm);
-    std::unique_ptr<ast::Module> parseMainModule();
+    BasicParser(TokenBuffer* tokens, SourceManager* sm);
+    BasicParser(TokenBuffer* tokens, SourceManager* sm, Builder builder);
+    Module parseMainModule();
+    // body of a function definition, starting at the cursor
+    CompoundStatement parseFunctionBody();
+
+    Builder* getBuilder() {
+        return &_builder;
+    }
+
+    // bodies must stay alive until the end of the parse
+    void usePreparsedBodies(const std::vector<PreparsedBody>* bodies) {
+        _preparsed = bodies;
+        _next_preparsed = 0;
+    }
+
+    // Lazy parse: function bodies are skipped, and loader parses them when
+    // they are first asked for. Only for builders with lazy_bodies.
+    void setBodyLoader(BodyLoader* loader) {
+        _body_loader = loader;
+    }
 
   private:
-    std::unique_ptr<ast::Declaration> parseDeclaration();
-    std::unique_ptr<ast::Module> parseModule();
-    std::unique_ptr<ast::FunctionDeclaration> parseFunctionDeclaration();
+    Declaration parseDeclaration();
+    Declaration parseModule();
+    Declaration parseFunctionDeclaration();
+    // the parameter names are the symbols since names_mark
+    Declaration parseFunctionDefinition(Symbol name, FunctionType* func_ty,
+                                        std::size_t names_mark,
+                                        SourceLocation loc);
     Type* parseQualType();
     BuiltinType* parseBuiltinType();
-    std::pair<std::vector<std::string>, std::vector<Type*>> readParams();
-
-    std::unique_ptr<ast::Statement> parseStatement();
-    std::unique_ptr<ast::LetStatement> parseLetStatement();
-    std::unique_ptr<ast::CompoundStatement> parseCompoundStatement();
-    std::unique_ptr<ast::SelectionStatement> parseSelectionStatement();
-    std::unique_ptr<ast::IterationStatement> parseIterationStatement();
-    std::unique_ptr<ast::ReturnStatement> parseReturnStatement();
-    std::unique_ptr<ast::ExpressionStatement> parseExpressionStatement();
-    std::unique_ptr<ast::Expression> parseExpression();
-    std::unique_ptr<ast::Expression> parseLogicalOrExpression();
-    std::unique_ptr<ast::Expression> parseLogicalAndExpression();
-    std::unique_ptr<ast::Expression> parseSimpleExpression();
-    std::unique_ptr<ast::Expression> parseAddExpression();
-    std::unique_ptr<ast::Expression> parseTermExpression();
-    std::unique_ptr<ast::Expression> parseCastExpression();
-    std::unique_ptr<ast::Expression> parseUnaryExpression();
-    std::unique_ptr<ast::Expression> parseSubscriptExpression();
-    std::unique_ptr<ast::Expression> parseFactorExpression();
-    std::unique_ptr<ast::IdentifierReference> parseIdentifierReference();
-    std::vector<std::unique_ptr<ast::Expression>> parseArgs();
+    // pushes the names and types of the parameters
+    void readParams();
 
+    Statement parseStatement();
+    Statement parseLetStatement();
+    CompoundStatement parseCompoundStatement();
+    Statement parseSelectionStatement();
+    Statement parseIterationStatement();
+    Statement parseReturnStatement();
+    Statement parseExpressionStatement();
+    Expression parseExpression();
+    Expression parseOperatorExpression(unsigned min_precedence);
+    Expression parseUnaryExpression();
+    Expression parseSubscriptExpression();
+    Expression parseFactorExpression();
+    IdentifierReference parseIdentifierReference();
+    // pushes the arguments
+    void parseArgs();
+
+    std::string_view value(const Token& tok);
+    template <class T>
+    T number(const Token& tok);
+    Symbol symbol(const Token& tok);
     void expect(Token::Kind kind);
     Token accept(Token::Kind kind);
+    void reportEndOfFile(Token::Kind expected);
 };
 
+extern template class BasicParser<ast::TreeBuilder>;
+extern template class BasicParser<flat::Builder>;
+
+using Parser = BasicParser<ast::TreeBuilder>;
+using FlatParser = BasicParser<flat::Builder>;
+
+// Parses the function bodies a lazy parse left out, see
+// FunctionDefinition::content. The tokens must live as long as the tree.
+// The diagnostics of a body are reported when it is parsed.
+class BodyLoader {
+    TokenBuffer* _tokens;
+    Parser _parser;
+
+  public:
+    BodyLoader(TokenBuffer* tokens, SourceManager* sm);
+
+    ast::CompoundStatement* load(std::size_t body_token);
+};
+
+// Index of the token after the brace closing the one at open, from the
+// braces matched by the token buffer alone. 0 when the token at open isn't
+// a brace, when it is never closed, or when a func keyword comes before
+// the match.
+std::size_t findBodyEnd(TokenBuffer* tokens, std::size_t open);
+
 } // namespace elang
 #endif // ELANG_PARSER_H
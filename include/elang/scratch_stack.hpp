@@ -0,0 +1,44 @@
+#ifndef ELANG_SCRATCH_STACK_H
+#define ELANG_SCRATCH_STACK_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <elang/arena.hpp>
+
+namespace elang {
+namespace util {
+
+// Storage shared by the lists a recursive parser collects at each nesting
+// level: a level remembers the top, pushes its elements above it, views
+// them once the levels it contains are done, and pops back to its mark.
+// The storage is kept, so once it has grown to the deepest nesting nothing
+// is allocated anymore.
+template <class T>
+class ScratchStack {
+    std::vector<T> _elements;
+
+  public:
+    std::size_t top() const {
+        return _elements.size();
+    }
+
+    void push(T element) {
+        _elements.push_back(std::move(element));
+    }
+
+    // elements pushed since mark, valid until the next push
+    Span<const T> since(std::size_t mark) const {
+        return {_elements.data() + mark, _elements.size() - mark};
+    }
+
+    void popTo(std::size_t mark) {
+        _elements.erase(_elements.begin() + mark, _elements.end());
+    }
+};
+
+} // namespace util
+} // namespace elang
+
+#endif // ELANG_SCRATCH_STACK_H
@@ -5,6 +5,7 @@
 #include <string>
 
 #include <elang/ast_visitor.hpp>
+#include <elang/parallel_sema.hpp>
 #include <elang/symbol_table.hpp>
 #include <elang/op_inferer.hpp>
 
@@ -14,42 +15,81 @@ class SourceManager;
 class TypeManager;
 class Type;
 class DiagnosticEngine;
+class StringInterner;
+
+namespace util {
+class Arena;
+}
 
 namespace ast {
 
-class SemaVisitor : public Visitor {
+// Checks a program in two phases: a walk over the modules and the function
+// signatures fills the global table, then the function bodies are checked
+// against it, on several threads if asked to. A function can thus call
+// the ones defined after it.
+class SemaVisitor : public StaticVisitor<SemaVisitor> {
+    // a body left for the second phase
+    struct PendingBody {
+        FunctionDefinition* node;
+        GlobalTable::ModuleId module; // where the function is defined
+    };
+    struct Worker;
+
     TypeManager* _type_manager;
     DiagnosticEngine* _diag_engine;
+    StringInterner* _interner;
+    util::Arena* _arena;
     OpInferer _op_inferer;
-    std::unique_ptr<LocalTable> _local_table;
-    GlobalTable _global_table;
+    LocalTable _local_table; // reset for each function
+    GlobalTable _global_table; // filled by the first phase
+    // the table bodies look names up in, the one of the visitor that
+    // walked the declarations
+    const GlobalTable* _globals;
+    std::vector<PendingBody> _pending;
+    SemaBodies _bodies;
 
+    GlobalTable::ModuleId _current_module;
     Type* _current_return_ty;
 
   public:
     explicit SemaVisitor(SourceManager* sm);
+    SemaVisitor(const SemaVisitor&) = delete;
+    SemaVisitor& operator=(const SemaVisitor&) = delete;
+
+    // Checks main_mod, the bodies on up to jobs threads. The diagnostics
+    // are reported once everything is checked, in source order whatever
+    // jobs is. Called once per visitor.
+    void check(Module* main_mod, unsigned jobs = 1);
+
+    void visit(BinaryOperator* node);
+    void visit(UnaryOperator* node);
+    void visit(SubscriptExpression* node);
+    void visit(CallExpression* node);
+    void visit(CastExpression* node);
+    void visit(LValueToRValueCastExpression* node);
+    void visit(IdentifierReference* node);
+    void visit(IntLiteral* node);
+    void visit(DoubleLiteral* node);
+    void visit(CharLiteral* node);
+    void visit(StringLiteral* node);
+    void visit(BoolLiteral* node);
+    void visit(CompoundStatement* node);
+    void visit(LetStatement* node);
+    void visit(ExpressionStatement* node);
+    void visit(SelectionStatement* node);
+    void visit(IterationStatement* node);
+    void visit(ReturnStatement* node);
+    void visit(FunctionDeclaration* node);
+    void visit(FunctionDefinition* node);
+    void visit(Module* node);
+
+  private:
+    // visitor for the bodies checked on another thread, allocating in arena
+    SemaVisitor(const SemaVisitor& parent, util::Arena* arena);
 
-    virtual void visit(BinaryOperator* node) override;
-    virtual void visit(UnaryOperator* node) override;
-    virtual void visit(SubscriptExpression* node) override;
-    virtual void visit(CallExpression* node) override;
-    virtual void visit(CastExpression* node) override;
-    virtual void visit(LValueToRValueCastExpression* node) override;
-    virtual void visit(IdentifierReference* node) override;
-    virtual void visit(IntLiteral* node) override;
-    virtual void visit(DoubleLiteral* node) override;
-    virtual void visit(CharLiteral* node) override;
-    virtual void visit(StringLiteral* node) override;
-    virtual void visit(BoolLiteral* node) override;
-    virtual void visit(CompoundStatement* node) override;
-    virtual void visit(LetStatement* node) override;
-    virtual void visit(ExpressionStatement* node) override;
-    virtual void visit(SelectionStatement* node) override;
-    virtual void visit(IterationStatement* node) override;
-    virtual void visit(ReturnStatement* node) override;
-    virtual void visit(FunctionDeclaration* node) override;
-    virtual void visit(FunctionDefinition* node) override;
-    virtual void visit(Module* node) override;
+    void checkBody(const PendingBody& body);
+    // wraps lvalues used as values, the cast is allocated in the AST arena
+    Expression* addL2RCast(Expression* expr);
 };
 
 } // namespace ast
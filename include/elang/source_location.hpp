@@ -1,17 +1,21 @@
 #ifndef ELANG_SOURCE_LOCATION_H
 #define ELANG_SOURCE_LOCATION_H
 
-#include <cstdlib>
+#include <cstdint>
 
 namespace elang {
 
+// Position in the sources of a SourceManager, packed in 32 bits: the
+// registered files are laid out one after the other in a single offset
+// space, each followed by the location of its eof, and the SourceManager
+// finds the file of a location back from where each file starts.
 class SourceLocation {
   public:
     SourceLocation() = delete;
-    SourceLocation(unsigned fileid, std::size_t offset);
+    constexpr explicit SourceLocation(std::uint32_t raw) : raw(raw) {
+    }
 
-    unsigned fileid;
-    std::size_t offset;
+    std::uint32_t raw;
 };
 
 } // namespace elang
@@ -1,12 +1,20 @@
 #ifndef ELANG_SOURCE_MANAGER_H
 #define ELANG_SOURCE_MANAGER_H
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <string_view>
 
+#include <elang/arena.hpp>
 #include <elang/type.hpp>
 #include <elang/diagnostic.hpp>
+#include <elang/mapped_file.hpp>
 #include <elang/source_reader.hpp>
+#include <elang/string_interner.hpp>
+#include <elang/token.hpp>
 #include <elang/user_location.hpp>
 
 namespace elang {
@@ -14,29 +22,82 @@ namespace elang {
 namespace util {
 struct FileRecord {
     FileRecord(std::string file_path, std::string buffer);
+    FileRecord(std::string file_path, MappedFile mapping);
+    FileRecord(const FileRecord&) = delete;
+    FileRecord& operator=(const FileRecord&) = delete;
+
     std::string file_path;
-    std::string buffer;
+    std::string_view buffer; // view over _storage or _mapping
+
+    // 1-based line containing offset, found by binary search in the line
+    // table
+    unsigned getLine(std::size_t offset);
+    std::size_t getLineStart(unsigned line);
+    std::string_view getLineText(unsigned line);
+
+  private:
+    std::string _storage;
+    MappedFile _mapping;
+
+    // offset of the first char of each line, built on first use
+    std::vector<std::uint32_t> _line_starts;
+    std::once_flag _line_starts_flag;
+
+    const std::vector<std::uint32_t>& getLineStarts();
 };
 }
 
 class SourceManager {
-    std::vector<util::FileRecord> _records;
+    std::vector<std::unique_ptr<util::FileRecord>> _records;
+    // location of the first char of each record, increasing
+    std::vector<std::uint32_t> _starts;
+    StringInterner _interner; // identifiers and decoded literals
     DiagnosticEngine _diag_engine;
     TypeManager _type_manager;
+    util::Arena _arena; // AST nodes, freed with the compilation unit
 
   public:
+    enum class LoadMode { Read, Map };
+
     SourceManager();
     SourceManager(const SourceManager&) = delete;
     SourceManager(SourceManager&&) = delete;
     SourceManager& operator=(const SourceManager&) = delete;
     SourceManager& operator=(SourceManager&&) = delete;
 
-    unsigned registerFile(std::string file_path);
+    // Map falls back to Read when the file can't be mapped
+    unsigned registerFile(std::string file_path,
+                          LoadMode mode = LoadMode::Map);
     unsigned registerStdin();
+    // in-memory source, name only shows up in diagnostics
+    unsigned registerBuffer(std::string name, std::string buffer);
     SourceReader getBuffer(unsigned fileid);
+    util::FileRecord* getFileRecord(unsigned fileid);
+
+    SourceLocation getLocation(unsigned fileid, std::size_t offset) const {
+        return SourceLocation{
+            static_cast<std::uint32_t>(_starts[fileid] + offset)};
+    }
+    // file holding loc, by binary search in the starts of the files
+    unsigned getFileId(SourceLocation loc) const;
+    std::size_t getFileOffset(SourceLocation loc) const {
+        return loc.raw - _starts[getFileId(loc)];
+    }
+
     DiagnosticEngine* getDiagnosticEngine();
     TypeManager* getTypeManager();
+    StringInterner* getInterner();
+    util::Arena* getArena();
     UserLocation getUserLocation(const SourceLocation& loc);
+
+    std::string_view getTokenSpelling(const Token& tok);
+    std::string_view getTokenValue(const Token& tok);
+
+    std::string_view getLineText(unsigned fileid, unsigned line);
+
+  private:
+    // gives the record its range of locations
+    unsigned addRecord(std::unique_ptr<util::FileRecord> record);
 };
 
 } // namespace elang
@@ -2,29 +2,30 @@
 #define ELANG_SOURCE_READER_H
 
 #include <string>
+#include <string_view>
 
 #include <elang/source_location.hpp>
 
 namespace elang {
 
 class SourceReader {
-    std::string::const_iterator _begin;
-    std::string::const_iterator _current;
-    std::string::const_iterator _end;
+    const char* _begin;
+    const char* _current;
+    const char* _end;
     SourceLocation _current_location;
 
   public:
-    SourceReader(std::string::const_iterator begin,
-                 std::string::const_iterator end, unsigned fileid)
-        : _begin(begin), _current(begin), _end(end),
-          _current_location(fileid, 0) {
+    // start is the location of the first char of buffer
+    SourceReader(std::string_view buffer, SourceLocation start)
+        : _begin(buffer.data()), _current(buffer.data()),
+          _end(buffer.data() + buffer.size()), _current_location(start) {
     }
 
     int get() {
         if (_current == _end) {
             return std::char_traits<char>::eof();
         }
-        ++_current_location.offset;
+        ++_current_location.raw;
         return *(_current++);
     }
 
@@ -35,9 +36,23 @@ class SourceReader {
         return *_current;
     }
 
+    // raw access for the scanners working on whole runs of chars
+    const char* position() const {
+        return _current;
+    }
+
+    std::size_t remaining() const {
+        return _end - _current;
+    }
+
+    void advance(std::size_t n) {
+        _current += n;
+        _current_location.raw += n;
+    }
+
     void unget() {
         --_current;
-        --_current_location.offset;
+        --_current_location.raw;
     }
 
     SourceLocation getCurrentLocation() {
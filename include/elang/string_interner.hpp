@@ -0,0 +1,79 @@
+#ifndef ELANG_STRING_INTERNER_H
+#define ELANG_STRING_INTERNER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace elang {
+
+// 32 bits handle on an interned string: two symbols are equal iff their
+// strings are
+class Symbol {
+  public:
+    std::uint32_t id;
+
+    constexpr Symbol() : id(0) {
+    }
+    constexpr explicit Symbol(std::uint32_t id) : id(id) {
+    }
+
+    // the empty string, always interned first
+    static constexpr Symbol empty() {
+        return Symbol{0};
+    }
+
+    friend bool operator==(Symbol lhs, Symbol rhs) {
+        return lhs.id == rhs.id;
+    }
+    friend bool operator!=(Symbol lhs, Symbol rhs) {
+        return lhs.id != rhs.id;
+    }
+    friend bool operator<(Symbol lhs, Symbol rhs) {
+        return lhs.id < rhs.id;
+    }
+};
+
+class StringInterner {
+    // the strings are copied in chunks that are never moved, so the views
+    // stay valid
+    std::vector<std::unique_ptr<char[]>> _chunks;
+    char* _chunk_current;
+    std::size_t _chunk_left;
+
+    std::vector<std::string_view> _strings; // indexed by symbol id
+    std::vector<std::uint32_t> _hashes;     // indexed by symbol id
+    std::vector<std::uint32_t> _table;      // open addressing, id + 1
+
+  public:
+    StringInterner();
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    Symbol intern(std::string_view str);
+    std::string_view get(Symbol sym) const {
+        return _strings[sym.id];
+    }
+    std::size_t size() const {
+        return _strings.size();
+    }
+
+  private:
+    const char* store(std::string_view str);
+    void grow();
+};
+
+} // namespace elang
+
+namespace std {
+template <>
+struct hash<elang::Symbol> {
+    std::size_t operator()(elang::Symbol sym) const noexcept {
+        return sym.id;
+    }
+};
+} // namespace std
+
+#endif // ELANG_STRING_INTERNER_H
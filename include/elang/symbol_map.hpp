@@ -0,0 +1,116 @@
+#ifndef ELANG_SYMBOL_MAP_H
+#define ELANG_SYMBOL_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <elang/string_interner.hpp>
+
+namespace elang {
+namespace util {
+
+// Open addressing map keyed by symbols, for the tables sema probes on every
+// identifier: a lookup hashes the id and scans a few adjacent slots, and
+// nothing is allocated but the slots themselves, which clear() keeps.
+// Entries can't be removed; T must be default constructible, and a value
+// can be set back to its default instead.
+template <class T>
+class SymbolMap {
+    struct Slot {
+        std::uint32_t key; // symbol id + 1, 0 when the slot is empty
+        T value;
+    };
+
+    static constexpr std::size_t initial_size = 8; // power of 2
+
+    std::vector<Slot> _slots;
+    std::size_t _size;
+
+  public:
+    SymbolMap() : _size(0) {
+    }
+
+    // nullptr when name is not there
+    T* find(Symbol name) {
+        return const_cast<T*>(static_cast<const SymbolMap*>(this)->find(name));
+    }
+    const T* find(Symbol name) const {
+        if (_slots.empty()) {
+            return nullptr;
+        }
+        auto mask = _slots.size() - 1;
+        for (auto slot = hash(name.id) & mask;; slot = (slot + 1) & mask) {
+            auto& entry = _slots[slot];
+            if (entry.key == name.id + 1) {
+                return &entry.value;
+            }
+            if (entry.key == 0) {
+                return nullptr;
+            }
+        }
+    }
+
+    // the value of name, default constructed when name wasn't there; valid
+    // until the next insertion
+    T& operator[](Symbol name) {
+        if ((_size + 1) * 2 > _slots.size()) {
+            grow();
+        }
+        auto mask = _slots.size() - 1;
+        for (auto slot = hash(name.id) & mask;; slot = (slot + 1) & mask) {
+            auto& entry = _slots[slot];
+            if (entry.key == name.id + 1) {
+                return entry.value;
+            }
+            if (entry.key == 0) {
+                entry.key = name.id + 1;
+                ++_size;
+                return entry.value;
+            }
+        }
+    }
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    // removes every entry and keeps the slots
+    void clear() {
+        for (auto& entry : _slots) {
+            entry = Slot{};
+        }
+        _size = 0;
+    }
+
+  private:
+    // symbols made together have consecutive ids, which would fill runs of
+    // adjacent slots that every miss nearby has to scan to their end
+    static std::uint32_t hash(std::uint32_t id) {
+        id *= 0x9e3779b1u;
+        return id ^ (id >> 16);
+    }
+
+    void grow() {
+        std::vector<Slot> slots(_slots.empty() ? initial_size
+                                               : _slots.size() * 2);
+        auto mask = slots.size() - 1;
+        for (auto& entry : _slots) {
+            if (entry.key == 0) {
+                continue;
+            }
+            auto slot = hash(entry.key - 1) & mask;
+            while (slots[slot].key != 0) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = std::move(entry);
+        }
+        _slots = std::move(slots);
+    }
+};
+
+} // namespace util
+} // namespace elang
+
+#endif // ELANG_SYMBOL_MAP_H
@@ -1,51 +1,100 @@
 #ifndef ELANG_SYMBOL_TABLE_H
 #define ELANG_SYMBOL_TABLE_H
 
-#include <string>
+#include <cstdint>
+#include <utility>
 #include <vector>
-#include <map>
 
+#include <elang/arena.hpp>
+#include <elang/string_interner.hpp>
+#include <elang/symbol_map.hpp>
 #include <elang/type.hpp>
 
 namespace elang {
 
+// Locals of the function being checked: one map from each name to its
+// innermost binding, and a log of the bindings a scope shadowed, which
+// ending the scope restores. Beginning and ending a scope only moves
+// marks in the log, and a lookup is one probe whatever the nesting.
 class LocalTable {
-    std::vector<std::map<std::string, Type*>> _scopes;
+    struct Binding {
+        Type* type = nullptr; // nullptr when nothing is bound
+        std::size_t depth = 0; // of the scope that bound it
+    };
+
+    struct Shadowed {
+        Symbol name;
+        Binding binding;
+    };
+
+    util::SymbolMap<Binding> _bindings;
+    std::vector<Shadowed> _shadowed;
+    // size of _shadowed when each scope began, the outermost first
+    std::vector<std::size_t> _scope_marks;
 
   public:
     LocalTable();
-    ~LocalTable();
 
     void beginScope();
     void endScope();
+    // back to a single empty scope, for the next function
+    void reset();
 
-    Type* get(const std::string& name);
-    bool put(const std::string& name,
+    Type* get(Symbol name);
+    bool put(Symbol name,
              Type* ty); // return false if name is already defined IN LAST
                         // SCOPE else return true
 };
 
+// Functions by module: one node per module, each with a map from the
+// names declared in it to their functions and submodules, so that a
+// lookup walks the tree, one probe per module on the way.
+//
+// The table is filled by a walk over the declarations; lookups only read
+// it, so once it is complete several threads can look names up at once.
 class GlobalTable {
   public:
     enum State { Defined, Declared, None };
+    using ModuleId = std::uint32_t;
 
   private:
-    std::map<std::string, std::pair<Type*, State>> _globals;
-    std::vector<std::string> _current_module_path;
+    static constexpr ModuleId no_module = ~ModuleId{0};
+
+    struct Entry {
+        Type* type = nullptr;
+        State state = State::None;
+        ModuleId module = no_module; // submodule of that name
+    };
+
+    struct Module {
+        ModuleId parent;
+        std::vector<Symbol> path; // from the root
+        util::SymbolMap<Entry> entries;
+    };
+
+    // the root, above the main module, first
+    std::vector<Module> _modules;
+    ModuleId _current_module;
 
   public:
-    GlobalTable() = default;
+    GlobalTable();
 
-    bool beginModule(const std::string& name); // return false if name is
-                                               // already in module path else
-                                               // return true
+    bool beginModule(Symbol name); // return false if name is already in
+                                   // module path else return true
     void endModule();
+    // the module the walk is in
+    ModuleId currentModule() const {
+        return _current_module;
+    }
 
-    Type* get(std::vector<std::string>& mod_path, const std::string& name);
-    std::pair<Type*, State> getStateInModule(const std::string& name);
+    // Looks mod_path::name up from module outwards. resolved_path receives
+    // the full module path of the match, valid as long as the table.
+    Type* get(ModuleId module, util::Span<const Symbol> mod_path, Symbol name,
+              util::Span<const Symbol>& resolved_path) const;
+    std::pair<Type*, State> getStateInModule(Symbol name) const;
 
-    void declare(const std::string& name, Type* ty);
-    void define(const std::string& name, Type* ty);
+    void declare(Symbol name, Type* ty);
+    void define(Symbol name, Type* ty);
 };
 
 } // namespace elang
@@ -1,30 +1,46 @@
 #ifndef ELANG_TOKEN_H
 #define ELANG_TOKEN_H
 
-#include <string>
+#include <cstdint>
+#include <string_view>
 #include <ostream>
 
 #include <elang/source_location.hpp>
 
 namespace elang {
 
+// A token only points into the source buffer: its value is recovered
+// through SourceManager::getTokenValue. Identifiers carry their interned
+// Symbol in data, and string and char literals holding escape sequences
+// carry the Symbol of their decoded value.
 class Token {
   public:
-    enum class Kind {
+    enum class Kind : std::uint8_t {
 #define TOK(X) X,
 #include <elang/tokenkind.def>
     };
 
+    enum Flags : std::uint8_t {
+        None = 0,
+        Decoded = 1 << 0, // data is the Symbol of the decoded literal
+    };
+
+    SourceLocation loc;
+    std::uint32_t length;
+    std::uint32_t data;
     Kind kind;
-    SourceLocation location;
-    std::string value;
+    std::uint8_t flags;
 
     Token() = delete;
-    Token(Kind kind, SourceLocation loc, std::string value = {})
-        : kind(kind), location(loc), value(value) {
+    Token(Kind kind, SourceLocation loc, std::uint32_t length = 0)
+        : loc(loc), length(length), data(0), kind(kind), flags(Flags::None) {
     }
 
-    static Token fromIdentifier(SourceLocation loc, const std::string& id);
+    static Token fromIdentifier(SourceLocation loc, std::string_view id);
+
+    SourceLocation location() const noexcept {
+        return loc;
+    }
 
     bool is(Kind k) const noexcept {
         return kind == k;
@@ -44,7 +60,7 @@ class Token {
     }
 };
 
-Token::Kind nameKind(const std::string& id);
+static_assert(sizeof(Token) == 16, "Token should stay 16 bytes large");
 
 } // namespace elang
 
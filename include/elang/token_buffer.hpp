@@ -0,0 +1,116 @@
+#ifndef ELANG_TOKEN_BUFFER_H
+#define ELANG_TOKEN_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <elang/token.hpp>
+
+namespace elang {
+
+class Lexer;
+
+// Tokens of a file stored as a structure of arrays, read through a cursor
+// with arbitrary lookahead. In Eager mode the whole file is lexed when the
+// buffer is built; in Streaming mode tokens are lexed the first time they
+// are peeked at, so lexer diagnostics stay interleaved with the parser
+// ones. The last token is always eof, and reading past it yields eof again.
+class TokenBuffer {
+  public:
+    enum class Mode { Streaming, Eager };
+
+  private:
+    Lexer* _lexer;
+    std::vector<Token::Kind> _kinds;
+    std::vector<SourceLocation> _locations;
+    std::vector<std::uint32_t> _lengths;
+    std::vector<std::uint32_t> _data;
+    std::vector<std::uint8_t> _flags;
+    std::size_t _cursor;
+    bool _complete; // eof has been lexed
+
+    // Opening braces with their closing one, 0 until it is lexed, and the
+    // func keywords, by token index: what is needed to skip a function body
+    // without going through its tokens.
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> _braces;
+    std::vector<std::uint32_t> _open_braces; // in _braces
+    std::vector<std::uint32_t> _functions;
+
+  public:
+    TokenBuffer(Lexer* lexer, Mode mode);
+    // filled by the caller through push, up to the eof token
+    TokenBuffer();
+    TokenBuffer(const TokenBuffer&) = delete;
+    TokenBuffer& operator=(const TokenBuffer&) = delete;
+
+    // n-th token after the cursor
+    Token peek(std::size_t n = 0) {
+        return at(_cursor + n);
+    }
+    Token::Kind peekKind(std::size_t n = 0) {
+        return kindAt(_cursor + n);
+    }
+    // kind of the index-th token of the file
+    Token::Kind kindAt(std::size_t index) {
+        if (index >= _kinds.size()) {
+            index = fill(index);
+        }
+        return _kinds[index];
+    }
+
+    Token get() {
+        auto tok = at(_cursor);
+        if (_cursor + 1 < _kinds.size() || !_complete) {
+            ++_cursor;
+        }
+        return tok;
+    }
+
+    // tokens lexed so far, all of them in Eager mode
+    std::size_t size() const {
+        return _kinds.size();
+    }
+
+    // index of the token under the cursor
+    std::size_t position() const {
+        return _cursor;
+    }
+    // moves the cursor to a token already lexed
+    void seek(std::size_t index) {
+        _cursor = index;
+    }
+
+    void push(const Token& tok);
+    void reserve(std::size_t count);
+    // replaces the content with the tokens [begin, end) of source, which
+    // must be lexed up to end, followed by an eof located at end; braces
+    // aren't matched in the copy
+    void assign(const TokenBuffer& source, std::size_t begin,
+                std::size_t end);
+
+    // index of the brace closing the one at open, lexing up to it, or 0
+    // when the token at open isn't a brace or is never closed
+    std::size_t closingBrace(std::size_t open);
+    // whether a func keyword lies strictly between the two tokens
+    bool hasFunctionBetween(std::size_t first, std::size_t last) const;
+
+  private:
+    Token at(std::size_t index) {
+        if (index >= _kinds.size()) {
+            index = fill(index);
+        }
+        Token tok{_kinds[index], _locations[index], _lengths[index]};
+        tok.data = _data[index];
+        tok.flags = _flags[index];
+        return tok;
+    }
+
+    // lexes until index is available, returns index clamped to the eof
+    std::size_t fill(std::size_t index);
+};
+
+} // namespace elang
+
+#endif // ELANG_TOKEN_BUFFER_H
@@ -1,34 +1,69 @@
 #ifndef ELANG_TYPE_H
 #define ELANG_TYPE_H
 
-#include <map>
-#include <vector>
-#include <utility>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <string>
-#include <memory>
+#include <vector>
+
+#include <elang/arena.hpp>
 
 namespace elang {
 
+class PointerType;
+class LValueType;
+
+// Types other than the builtins live in the arena of their TypeManager,
+// which never runs their destructors: they must stay trivially
+// destructible.
 class Type {
   public:
     enum class Variety { Builtin, Array, Pointer, LValue, Function };
 
-    explicit Type(Variety var);
+    // what a type can be used for, known when it is made so that checking
+    // an operand is a bit test
+    enum Property : std::uint8_t {
+        Arithmetic = 1 << 0,
+        Integral = 1 << 1,
+        Pointer = 1 << 2,
+        LValue = 1 << 3,
+        Function = 1 << 4,
+    };
+
+    Type(Variety var, std::uint8_t properties);
 
     virtual std::string toString() const = 0;
 
+    bool is(Property property) const {
+        return (properties & property) != 0;
+    }
+
     Variety variety;
+    std::uint8_t properties;
+    // dense among the types of a TypeManager, in the order they are made
+    std::uint32_t id;
+
+  private:
+    // the pointer and lvalue types of this one once they are made, so that
+    // getting them again takes neither the lock of the manager nor a probe
+    std::atomic<PointerType*> _pointer_ty;
+    std::atomic<LValueType*> _lvalue_ty;
+
+    friend class TypeManager;
 };
 
 class BuiltinType : public Type {
   public:
     enum Kind { Void_ty, Int_ty, Double_ty, Char_ty, Bool_ty };
+    // the builtins are made first, their ids are their kinds
+    static constexpr std::uint32_t count = Bool_ty + 1;
 
   private:
     explicit BuiltinType(Kind kind);
 
   public:
-    virtual ~BuiltinType() = default;
     virtual std::string toString() const override;
 
     Kind kind;
@@ -40,7 +75,6 @@ class ArrayType : public Type {
     ArrayType(Type* subtype, std::size_t size);
 
   public:
-    virtual ~ArrayType() = default;
     virtual std::string toString() const override;
 
     Type* subtype;
@@ -53,7 +87,6 @@ class PointerType : public Type {
     PointerType(Type* subtype);
 
   public:
-    virtual ~PointerType() = default;
     virtual std::string toString() const override;
 
     Type* subtype;
@@ -65,7 +98,6 @@ class LValueType : public Type {
     LValueType(Type* subtype);
 
   public:
-    virtual ~LValueType() = default;
     virtual std::string toString() const override;
 
     Type* subtype;
@@ -74,32 +106,47 @@ class LValueType : public Type {
 };
 
 class FunctionType : public Type {
-    FunctionType(Type* return_ty, std::vector<Type*> params_ty);
+    FunctionType(Type* return_ty, util::Span<Type* const> params_ty);
 
   public:
-    virtual ~FunctionType() = default;
     virtual std::string toString() const override;
 
     Type* return_type;
-    std::vector<Type*> params_types;
+    util::Span<Type* const> params_types; // in the arena of the manager
 
     friend class TypeManager;
 };
 
+// Hands out the unique instance of every type, so that types compare by
+// address. Array and function types are hash-consed: one open addressing
+// table holds them, and a lookup probes it once, comparing the fields of
+// the candidates against the arguments, and makes the type in the slot it
+// stopped at when it isn't there. Pointer and lvalue types are found from
+// their subtype.
+//
+// Types can be got from several threads at once: making one takes a lock,
+// and pointer and lvalue types already made are read without it.
 class TypeManager {
+    struct Slot {
+        std::uint64_t hash;
+        Type* type; // nullptr when empty
+    };
+
     BuiltinType _void_ty;
     BuiltinType _int_ty;
     BuiltinType _double_ty;
     BuiltinType _char_ty;
     BuiltinType _bool_ty;
-    std::map<std::pair<Type*, std::size_t>, ArrayType*> _array_types;
-    std::map<Type*, PointerType*> _ptr_types;
-    std::map<Type*, LValueType*> _lval_types;
-    std::map<std::pair<Type*, std::vector<Type*>>, FunctionType*> _func_types;
+    std::mutex _mutex; // over everything below
+    util::Arena _arena;
+    std::vector<Slot> _table;
+    std::size_t _table_count;
+    std::uint32_t _size;
 
   public:
     TypeManager();
-    ~TypeManager();
+    TypeManager(const TypeManager&) = delete;
+    TypeManager& operator=(const TypeManager&) = delete;
 
     BuiltinType* getVoidType();
     BuiltinType* getIntType();
@@ -109,7 +156,25 @@ class TypeManager {
     ArrayType* getArrayType(Type* subtype, std::size_t size);
     PointerType* getPointerType(Type* subtype);
     LValueType* getLValueType(Type* subtype);
-    FunctionType* getFunctionType(Type* ret_ty, std::vector<Type*> param_ty);
+    // param_ty is only copied when the type is new
+    FunctionType* getFunctionType(Type* ret_ty,
+                                  util::Span<Type* const> param_ty);
+
+    // types made so far, builtins included: every id is below it
+    std::uint32_t size();
+    // bytes the derived types take in the arena
+    std::size_t bytesUsed();
+
+  private:
+    // finds the type of variety T with hash for which matches holds, or
+    // makes it with make, under the lock
+    template <class T, class Matches, class Make>
+    T* intern(Type::Variety variety, std::uint64_t hash, Matches matches,
+              Make make);
+    // under the lock
+    template <class T, class... Args>
+    T* make(Args&&... args);
+    void grow();
 };
 
 } // namespace elang
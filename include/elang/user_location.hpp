@@ -2,6 +2,7 @@
 #define ELANG_USER_LOCATION_H
 
 #include <string>
+#include <string_view>
 
 namespace elang {
 
@@ -10,11 +11,11 @@ class UserLocation {
     std::string file_name;
     unsigned line;
     unsigned column;
-    std::string line_string;
+    std::string_view line_string; // view into the source buffer
     bool is_eof;
 
     UserLocation(std::string file_name, unsigned line, unsigned column,
-                 std::string line_string, bool is_eof);
+                 std::string_view line_string, bool is_eof);
 };
 
 } // namespace elang
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include <elang/alloc_stats.hpp>
+#include <elang/flat_sema.hpp>
+#include <elang/lexer.hpp>
+#include <elang/parser.hpp>
+#include <elang/sema_visitor.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+#include "bench.hpp"
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+void reportAllocations(const std::string& name, util::AllocationStats stats,
+                       std::size_t lines) {
+    std::cout << name << ": " << stats.count << " allocations, "
+              << (lines ? stats.count * 1000.0 / lines : 0)
+              << " per 1k lines, " << stats.bytes << " bytes" << std::endl;
+}
+
+} // namespace
+
+// allocations of each phase of the front end, the token buffer is eager
+// so that the parser ones don't include the lexer ones
+int runAllocBench(const Args& args) {
+    if (args.empty()) {
+        std::cerr << "alloc: missing input file\n";
+        return 1;
+    }
+
+    SourceManager source_manager;
+    auto fileid = source_manager.registerFile(args[0]);
+    auto buffer = source_manager.getFileRecord(fileid)->buffer;
+    std::size_t lines = std::count(buffer.begin(), buffer.end(), '\n');
+
+    {
+        Lexer lexer{&source_manager, fileid};
+        auto before = util::allocationStats();
+        while (lexer.getToken().isNot(Token::Kind::eof)) {
+        }
+        reportAllocations("alloc/lexer", util::allocationStats() - before,
+                          lines);
+    }
+
+    Lexer lexer{&source_manager, fileid};
+    TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+    {
+        Parser parser{&tokens, &source_manager};
+        auto before = util::allocationStats();
+        auto main_mod = parser.parseMainModule();
+        reportAllocations("alloc/parser", util::allocationStats() - before,
+                          lines);
+
+        ast::SemaVisitor sema_visitor{&source_manager};
+        before = util::allocationStats();
+        sema_visitor.check(main_mod);
+        reportAllocations("alloc/sema", util::allocationStats() - before,
+                          lines);
+    }
+    {
+        tokens.seek(0);
+        FlatParser parser{&tokens, &source_manager};
+        auto before = util::allocationStats();
+        auto tree = parser.getBuilder()->finish(parser.parseMainModule());
+        reportAllocations("alloc/flat/parser",
+                          util::allocationStats() - before, lines);
+
+        flat::Sema sema{&source_manager};
+        before = util::allocationStats();
+        sema.check(&tree);
+        reportAllocations("alloc/flat/sema", util::allocationStats() - before,
+                          lines);
+    }
+    return 0;
+}
+
+} // namespace bench
+} // namespace elang
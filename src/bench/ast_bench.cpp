@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <sys/resource.h>
+
+#include <elang/lexer.hpp>
+#include <elang/parser.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+#include "bench.hpp"
+#include "generator.hpp"
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+// in kilobytes on linux
+long peakResidentSize() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void reportMemory(const std::string& name, std::size_t kilobytes) {
+    std::cout << name << ": " << kilobytes << " KB" << std::endl;
+}
+
+} // namespace
+
+// parse time, teardown time and memory of the AST of a generated program,
+// run once since the peak resident size can only grow
+int runAstBench(const Args& args) {
+    ProgramShape shape;
+    shape.functions = args.size() > 0 ? std::stoul(args[0]) : 50000;
+
+    auto program = generateProgram(shape);
+    std::size_t lines = std::count(program.begin(), program.end(), '\n');
+
+    auto source_manager = std::make_unique<SourceManager>();
+    auto fileid = source_manager->registerBuffer("<generated>", program);
+    Lexer lexer{source_manager.get(), fileid};
+    TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+
+    auto rss_before = peakResidentSize();
+    Parser parser{&tokens, source_manager.get()};
+    Timer parse_timer;
+    parser.parseMainModule();
+    reportRate("ast/parse", lines, "lines", parse_timer.seconds());
+    reportMemory("ast/peak-growth", peakResidentSize() - rss_before);
+    reportMemory("ast/arena-used",
+                 source_manager->getArena()->bytesUsed() / 1024);
+    reportMemory("ast/arena-allocated",
+                 source_manager->getArena()->bytesAllocated() / 1024);
+
+    Timer teardown_timer;
+    source_manager.reset();
+    reportRate("ast/teardown", lines, "lines", teardown_timer.seconds());
+    return 0;
+}
+
+} // namespace bench
+} // namespace elang
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <elang/flat_binary.hpp>
+#include <elang/flat_sema.hpp>
+#include <elang/lexer.hpp>
+#include <elang/parser.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+#include "bench.hpp"
+#include "generator.hpp"
+
+namespace elang {
+namespace bench {
+
+// Reading a generated program back from a binary tree file against lexing
+// and parsing it again. Both go through files, since a binary tree refers
+// to its source by path. Sema runs on both trees, a mapped tree is only
+// read from the disk as sema touches it.
+int runAstBinBench(const Args& args) {
+    ProgramShape shape;
+    shape.functions = args.size() > 0 ? std::stoul(args[0]) : 20000;
+    unsigned iterations = args.size() > 1 ? std::stoul(args[1]) : 5;
+
+    auto program = generateProgram(shape);
+    std::size_t lines = std::count(program.begin(), program.end(), '\n');
+
+    auto directory = std::filesystem::temp_directory_path();
+    auto source_path = (directory / "elang_astbin_bench.el").string();
+    auto tree_path = (directory / "elang_astbin_bench.bin").string();
+    std::ofstream{source_path, std::ios::binary} << program;
+
+    double reparse_seconds = 0;
+    double reparse_sema_seconds = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        Timer timer;
+        SourceManager source_manager;
+        auto fileid = source_manager.registerFile(source_path);
+        Lexer lexer{&source_manager, fileid};
+        TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+        FlatParser parser{&tokens, &source_manager};
+        parser.getBuilder()->reserve(tokens.size());
+        auto tree = parser.getBuilder()->finish(parser.parseMainModule());
+        reparse_seconds += timer.seconds();
+
+        if (i == 0) {
+            std::ofstream out{tree_path, std::ios::binary};
+            flat::writeBinaryTree(tree, &source_manager, out);
+        }
+
+        flat::Sema sema{&source_manager};
+        Timer sema_timer;
+        sema.check(&tree);
+        reparse_sema_seconds += sema_timer.seconds();
+    }
+
+    double load_seconds = 0;
+    double load_sema_seconds = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        Timer timer;
+        SourceManager source_manager;
+        auto tree = flat::readBinaryTree(tree_path, &source_manager);
+        load_seconds += timer.seconds();
+
+        flat::Sema sema{&source_manager};
+        Timer sema_timer;
+        sema.check(&tree);
+        load_sema_seconds += sema_timer.seconds();
+    }
+
+    reportRate("astbin/reparse", lines * iterations, "lines",
+               reparse_seconds);
+    reportRate("astbin/reparse/sema", lines * iterations, "lines",
+               reparse_sema_seconds);
+    reportRate("astbin/load", lines * iterations, "lines", load_seconds);
+    reportRate("astbin/load/sema", lines * iterations, "lines",
+               load_sema_seconds);
+    std::cout << "astbin/source bytes: " << program.size() << std::endl;
+    std::cout << "astbin/tree bytes: " << std::filesystem::file_size(tree_path)
+              << std::endl;
+
+    std::remove(source_path.c_str());
+    std::remove(tree_path.c_str());
+    return 0;
+}
+
+} // namespace bench
+} // namespace elang
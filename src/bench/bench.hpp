@@ -0,0 +1,49 @@
+#ifndef ELANG_BENCH_H
+#define ELANG_BENCH_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace elang {
+namespace bench {
+
+using Args = std::vector<std::string>;
+
+class Timer {
+    std::chrono::steady_clock::time_point _start;
+
+  public:
+    Timer() : _start(std::chrono::steady_clock::now()) {
+    }
+
+    double seconds() const {
+        std::chrono::duration<double> elapsed
+            = std::chrono::steady_clock::now() - _start;
+        return elapsed.count();
+    }
+};
+
+// prints `name: <amount> <unit> in <seconds>s (<rate> <unit>/s)`, or one
+// JSON object per line with --json
+void reportRate(const std::string& name, double amount,
+                const std::string& unit, double seconds);
+
+int runAllocBench(const Args& args);
+int runAstBench(const Args& args);
+int runAstBinBench(const Args& args);
+int runFlatBench(const Args& args);
+int runFrontendBench(const Args& args);
+int runKeywordBench(const Args& args);
+int runLazyBench(const Args& args);
+int runLexBench(const Args& args);
+int runLoadBench(const Args& args);
+int runScanBench(const Args& args);
+int runScopeBench(const Args& args);
+int runTokenBench(const Args& args);
+int runTypeBench(const Args& args);
+
+} // namespace bench
+} // namespace elang
+
+#endif // ELANG_BENCH_H
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include <elang/flat_sema.hpp>
+#include <elang/lexer.hpp>
+#include <elang/parser.hpp>
+#include <elang/sema_visitor.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+#include "bench.hpp"
+#include "generator.hpp"
+
+namespace elang {
+namespace bench {
+
+// parser and sema on the pointer-linked tree against the flat one, on a
+// generated program
+int runFlatBench(const Args& args) {
+    ProgramShape shape;
+    shape.functions = args.size() > 0 ? std::stoul(args[0]) : 20000;
+    unsigned iterations = args.size() > 1 ? std::stoul(args[1]) : 5;
+
+    auto program = generateProgram(shape);
+    std::size_t lines = std::count(program.begin(), program.end(), '\n');
+
+    double tree_parser_seconds = 0;
+    double tree_sema_seconds = 0;
+    std::size_t tree_bytes = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        SourceManager source_manager;
+        auto fileid = source_manager.registerBuffer("<generated>", program);
+        Lexer lexer{&source_manager, fileid};
+        TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+
+        Parser parser{&tokens, &source_manager};
+        Timer parser_timer;
+        auto main_mod = parser.parseMainModule();
+        tree_parser_seconds += parser_timer.seconds();
+        tree_bytes = source_manager.getArena()->bytesUsed();
+
+        ast::SemaVisitor sema_visitor{&source_manager};
+        Timer sema_timer;
+        sema_visitor.check(main_mod);
+        tree_sema_seconds += sema_timer.seconds();
+    }
+
+    double flat_parser_seconds = 0;
+    double flat_sema_seconds = 0;
+    std::size_t flat_bytes = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        SourceManager source_manager;
+        auto fileid = source_manager.registerBuffer("<generated>", program);
+        Lexer lexer{&source_manager, fileid};
+        TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+
+        FlatParser parser{&tokens, &source_manager};
+        Timer parser_timer;
+        parser.getBuilder()->reserve(tokens.size());
+        auto root = parser.parseMainModule();
+        auto tree = parser.getBuilder()->finish(root);
+        flat_parser_seconds += parser_timer.seconds();
+        flat_bytes = tree.bytesUsed();
+
+        flat::Sema sema{&source_manager};
+        Timer sema_timer;
+        sema.check(&tree);
+        flat_sema_seconds += sema_timer.seconds();
+    }
+
+    reportRate("flat/tree/parser", lines * iterations, "lines",
+               tree_parser_seconds);
+    reportRate("flat/tree/sema", lines * iterations, "lines",
+               tree_sema_seconds);
+    reportRate("flat/flat/parser", lines * iterations, "lines",
+               flat_parser_seconds);
+    reportRate("flat/flat/sema", lines * iterations, "lines",
+               flat_sema_seconds);
+    std::cout << "flat/tree/bytes: " << tree_bytes << std::endl;
+    std::cout << "flat/flat/bytes: " << flat_bytes << std::endl;
+    return 0;
+}
+
+} // namespace bench
+} // namespace elang
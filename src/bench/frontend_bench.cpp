@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include <elang/lexer.hpp>
+#include <elang/parallel_parser.hpp>
+#include <elang/parser.hpp>
+#include <elang/sema_visitor.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+#include "bench.hpp"
+#include "generator.hpp"
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+bool parseOption(const std::string& arg, const std::string& name,
+                 unsigned* value) {
+    auto prefix = "--" + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    *value = std::stoul(arg.substr(prefix.size()));
+    return true;
+}
+
+} // namespace
+
+// times the lexer, the parser and sema separately on a generated program,
+// with the function bodies parsed on parse-jobs threads and checked on
+// sema-jobs threads when they are above 1
+int runFrontendBench(const Args& args) {
+    ProgramShape shape;
+    unsigned iterations = 5;
+    unsigned parse_jobs = 0;
+    unsigned sema_jobs = 1;
+    bool emit = false;
+    for (auto& arg : args) {
+        if (arg == "--emit") {
+            emit = true;
+        } else if (!parseOption(arg, "functions", &shape.functions)
+                   && !parseOption(arg, "mod-depth", &shape.mod_depth)
+                   && !parseOption(arg, "expression-length",
+                                   &shape.expression_length)
+                   && !parseOption(arg, "statements", &shape.statements)
+                   && !parseOption(arg, "seed", &shape.seed)
+                   && !parseOption(arg, "iterations", &iterations)
+                   && !parseOption(arg, "parse-jobs", &parse_jobs)
+                   && !parseOption(arg, "sema-jobs", &sema_jobs)) {
+            std::cerr << "frontend: unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    auto program = generateProgram(shape);
+    if (emit) {
+        std::cout << program;
+        return 0;
+    }
+    std::size_t lines = std::count(program.begin(), program.end(), '\n');
+    std::size_t tokens = 0;
+
+    double lexer_seconds = 0;
+    double parser_seconds = 0;
+    double sema_seconds = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        SourceManager source_manager;
+        auto fileid = source_manager.registerBuffer("<generated>", program);
+
+        Lexer lexer{&source_manager, fileid};
+        Timer lexer_timer;
+        TokenBuffer token_buffer{&lexer, TokenBuffer::Mode::Eager};
+        lexer_seconds += lexer_timer.seconds();
+        tokens = token_buffer.size();
+
+        Timer parser_timer;
+        auto main_mod
+            = parseInParallel(&token_buffer, &source_manager, parse_jobs);
+        parser_seconds += parser_timer.seconds();
+
+        ast::SemaVisitor sema_visitor{&source_manager};
+        Timer sema_timer;
+        sema_visitor.check(main_mod, sema_jobs);
+        sema_seconds += sema_timer.seconds();
+    }
+
+    for (auto& phase : {std::make_pair("lexer", lexer_seconds),
+                        std::make_pair("parser", parser_seconds),
+                        std::make_pair("sema", sema_seconds)}) {
+        auto name = std::string{"frontend/"} + phase.first;
+        reportRate(name, lines * iterations, "lines", phase.second);
+        reportRate(name, tokens * iterations, "tokens", phase.second);
+    }
+    return 0;
+}
+
+} // namespace bench
+} // namespace elang
@@ -0,0 +1,191 @@
+#include "generator.hpp"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+// Functions all have the type (int, int) -> int and only use int values.
+// Function i lives at level i % (mod_depth + 1), level k being the module
+// chain m1::...::mk, and calls the functions emitted before it, which are
+// all in enclosing modules so that both plain and qualified names resolve.
+class Generator {
+    const ProgramShape& _shape;
+    std::mt19937 _rng;
+    std::string _out;
+    std::string _indent;
+
+    // (level, index) of the functions emitted so far
+    std::vector<std::pair<unsigned, unsigned>> _callables;
+    std::vector<std::string> _variables; // of the current function
+
+  public:
+    explicit Generator(const ProgramShape& shape)
+        : _shape(shape), _rng(shape.seed) {
+    }
+
+    std::string generate() {
+        emitLevel(0);
+        return std::move(_out);
+    }
+
+  private:
+    unsigned random(unsigned bound) {
+        return std::uniform_int_distribution<unsigned>{0, bound - 1}(_rng);
+    }
+
+    void line(const std::string& text) {
+        _out += _indent;
+        _out += text;
+        _out += '\n';
+    }
+
+    void indent() {
+        _indent += "    ";
+    }
+
+    void dedent() {
+        _indent.resize(_indent.size() - 4);
+    }
+
+    void emitLevel(unsigned level) {
+        for (unsigned i = level; i < _shape.functions;
+             i += _shape.mod_depth + 1) {
+            emitFunction(level, i);
+        }
+        if (level < _shape.mod_depth) {
+            line("mod m" + std::to_string(level + 1) + " {");
+            indent();
+            emitLevel(level + 1);
+            dedent();
+            line("}");
+        }
+    }
+
+    void emitFunction(unsigned level, unsigned index) {
+        line("# function " + std::to_string(index));
+        line("func f" + std::to_string(index)
+             + "(a : int, b : int) -> int {");
+        indent();
+        _variables = {"a", "b"};
+        for (unsigned i = 0; i < _shape.statements; ++i) {
+            emitStatement(i);
+        }
+        line("return " + expression(_shape.expression_length) + ";");
+        dedent();
+        line("}");
+        _callables.emplace_back(level, index);
+    }
+
+    void emitStatement(unsigned index) {
+        switch (index % 5) {
+        case 0: {
+            auto name = "v" + std::to_string(index);
+            auto type = random(2) ? " : int" : "";
+            line("let " + name + type + " = "
+                 + expression(_shape.expression_length) + ";");
+            _variables.push_back(name);
+            break;
+        }
+        case 1:
+            line(variable() + " = " + expression(_shape.expression_length)
+                 + ";");
+            break;
+        case 2:
+            line("if " + condition() + " {");
+            indent();
+            line(variable() + " = " + expression(_shape.expression_length)
+                 + ";");
+            dedent();
+            line("} else if " + condition() + " {");
+            indent();
+            line(variable() + " = " + expression(_shape.expression_length)
+                 + ";");
+            dedent();
+            line("} else {");
+            indent();
+            line(variable() + " = -" + variable() + ";");
+            dedent();
+            line("}");
+            break;
+        case 3: {
+            auto counter = variable();
+            line("while " + counter + " < " + std::to_string(random(100))
+                 + " {");
+            indent();
+            line(counter + " = " + counter + " + 1;");
+            dedent();
+            line("}");
+            break;
+        }
+        default:
+            if (_callables.empty()) {
+                line(variable() + " = " + expression(_shape.expression_length)
+                     + ";");
+            } else {
+                auto half = _shape.expression_length / 2 + 1;
+                line(variable() + " = " + callee() + "(" + expression(half)
+                     + ", " + expression(half) + ");");
+            }
+            break;
+        }
+    }
+
+    std::string variable() {
+        return _variables[random(_variables.size())];
+    }
+
+    std::string callee() {
+        auto& callable = _callables[random(_callables.size())];
+        auto name = "f" + std::to_string(callable.second);
+        if (callable.first > 0 && random(2)) {
+            return "m" + std::to_string(callable.first) + "::" + name;
+        }
+        return name;
+    }
+
+    std::string condition() {
+        static const char* const relops[] = {"<", "<=", ">", ">=", "==", "!="};
+        auto half = _shape.expression_length / 2 + 1;
+        return expression(half) + " " + relops[random(6)] + " "
+               + expression(half);
+    }
+
+    std::string operand() {
+        switch (random(4)) {
+        case 0:
+            return std::to_string(random(1000));
+        case 1:
+            return "-" + variable();
+        default:
+            return variable();
+        }
+    }
+
+    std::string expression(unsigned operands) {
+        static const char* const ops[] = {"+", "-", "*", "/", "%"};
+        if (operands <= 1) {
+            return operand();
+        }
+        auto op = std::string{" "} + ops[random(5)] + " ";
+        if (operands >= 4 && random(4) == 0) {
+            auto half = operands / 2;
+            return "(" + expression(half) + ")" + op
+                   + expression(operands - half);
+        }
+        return operand() + op + expression(operands - 1);
+    }
+};
+
+} // namespace
+
+std::string generateProgram(const ProgramShape& shape) {
+    return Generator{shape}.generate();
+}
+
+} // namespace bench
+} // namespace elang
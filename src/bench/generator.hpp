@@ -0,0 +1,24 @@
+#ifndef ELANG_BENCH_GENERATOR_H
+#define ELANG_BENCH_GENERATOR_H
+
+#include <string>
+
+namespace elang {
+namespace bench {
+
+// shape of a generated program, every one of them goes through sema
+// without any error
+struct ProgramShape {
+    unsigned functions = 1000;
+    unsigned mod_depth = 2;         // functions are spread on depth + 1 levels
+    unsigned expression_length = 8; // operands per expression
+    unsigned statements = 8;        // per function, the return excluded
+    unsigned seed = 42;
+};
+
+std::string generateProgram(const ProgramShape& shape);
+
+} // namespace bench
+} // namespace elang
+
+#endif // ELANG_BENCH_GENERATOR_H
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <elang/lexer.hpp>
+#include <elang/source_manager.hpp>
+
+#include "bench.hpp"
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+// the former keyword recognition: one string comparison per keyword
+Token::Kind linearKind(const std::string& id) {
+    if (id == "true" || id == "false") {
+        return Token::Kind::boolean_literal;
+    }
+#define KEYWORD(X)                                                             \
+    if (id == #X) {                                                            \
+        return Token::Kind::kw_##X;                                            \
+    }
+#include <elang/tokenkind.def>
+    return Token::Kind::identifier;
+}
+
+bool isWord(const Token& tok) {
+    switch (tok.kind) {
+    case Token::Kind::identifier:
+    case Token::Kind::boolean_literal:
+#define KEYWORD(X) case Token::Kind::kw_##X:
+#include <elang/tokenkind.def>
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+// classifies every identifier and keyword of the file, with the perfect
+// hash of Token::fromIdentifier and with the former comparison chain
+int runKeywordBench(const Args& args) {
+    if (args.empty()) {
+        std::cerr << "keywords: missing input file\n";
+        return 1;
+    }
+    unsigned iterations = args.size() > 1 ? std::stoul(args[1]) : 20;
+
+    SourceManager source_manager;
+    auto fileid = source_manager.registerFile(args[0]);
+    std::vector<std::string_view> words;
+    std::vector<std::string> word_strings;
+    Lexer lexer{&source_manager, fileid};
+    for (auto tok = lexer.getToken(); tok.isNot(Token::Kind::eof);
+         tok = lexer.getToken()) {
+        if (isWord(tok)) {
+            words.push_back(source_manager.getTokenSpelling(tok));
+            word_strings.emplace_back(words.back());
+        }
+    }
+
+    auto loc = source_manager.getLocation(fileid, 0);
+    unsigned checksum = 0;
+    Timer hash_timer;
+    for (unsigned i = 0; i < iterations; ++i) {
+        for (auto word : words) {
+            checksum += static_cast<unsigned>(
+                Token::fromIdentifier(loc, word).kind);
+        }
+    }
+    reportRate("keywords/perfect-hash", double(words.size()) * iterations,
+               "words", hash_timer.seconds());
+
+    unsigned linear_checksum = 0;
+    Timer linear_timer;
+    for (unsigned i = 0; i < iterations; ++i) {
+        for (auto& word : word_strings) {
+            linear_checksum += static_cast<unsigned>(linearKind(word));
+        }
+    }
+    reportRate("keywords/linear", double(words.size()) * iterations, "words",
+               linear_timer.seconds());
+
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        if (Token::fromIdentifier(loc, words[i]).kind
+            != linearKind(word_strings[i])) {
+            std::cerr << "keywords: `" << words[i] << "` is misclassified\n";
+            return 1;
+        }
+    }
+    return checksum == linear_checksum ? 0 : 1;
+}
+
+} // namespace bench
+} // namespace elang
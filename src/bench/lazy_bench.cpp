@@ -0,0 +1,86 @@
+#include <iostream>
+#include <string>
+
+#include <elang/ast.hpp>
+#include <elang/lexer.hpp>
+#include <elang/parser.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+#include "bench.hpp"
+#include "generator.hpp"
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+// parses every lazy body of the module, returns the number of bodies
+std::size_t loadBodies(ast::Module* module) {
+    std::size_t count = 0;
+    for (auto decl : module->declarations) {
+        if (decl->node_kind == ast::NodeKind::Module) {
+            count += loadBodies(static_cast<ast::Module*>(decl));
+        } else if (decl->node_kind == ast::NodeKind::FunctionDefinition) {
+            static_cast<ast::FunctionDefinition*>(decl)->content();
+            ++count;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+// Eager parse against a lazy one that only reads the signatures, then the
+// lazy bodies loaded one by one, on generated programs with the same
+// functions and more and more statements in them
+int runLazyBench(const Args& args) {
+    ProgramShape shape;
+    shape.functions = args.size() > 0 ? std::stoul(args[0]) : 20000;
+    unsigned iterations = args.size() > 1 ? std::stoul(args[1]) : 5;
+
+    for (unsigned statements : {2u, 8u, 32u}) {
+        shape.statements = statements;
+        auto program = generateProgram(shape);
+        auto suffix = "/" + std::to_string(statements);
+
+        double eager_seconds = 0;
+        double lazy_seconds = 0;
+        double load_seconds = 0;
+        for (unsigned i = 0; i < iterations; ++i) {
+            SourceManager source_manager;
+            auto fileid = source_manager.registerBuffer("<generated>",
+                                                        program);
+            Lexer lexer{&source_manager, fileid};
+            TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+
+            Parser eager_parser{&tokens, &source_manager};
+            Timer eager_timer;
+            eager_parser.parseMainModule();
+            eager_seconds += eager_timer.seconds();
+
+            tokens.seek(0);
+            BodyLoader body_loader{&tokens, &source_manager};
+            Parser lazy_parser{&tokens, &source_manager};
+            lazy_parser.setBodyLoader(&body_loader);
+            Timer lazy_timer;
+            auto main_mod = lazy_parser.parseMainModule();
+            lazy_seconds += lazy_timer.seconds();
+
+            Timer load_timer;
+            loadBodies(main_mod);
+            load_seconds += load_timer.seconds();
+        }
+
+        reportRate("lazy/eager" + suffix, shape.functions * iterations,
+                   "functions", eager_seconds);
+        reportRate("lazy/signatures" + suffix, shape.functions * iterations,
+                   "functions", lazy_seconds);
+        reportRate("lazy/bodies" + suffix, shape.functions * iterations,
+                   "functions", load_seconds);
+    }
+    return 0;
+}
+
+} // namespace bench
+} // namespace elang
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <string>
+
+#include <elang/lexer.hpp>
+#include <elang/parallel_lexer.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+#include "bench.hpp"
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+bool sameTokens(TokenBuffer& lhs, TokenBuffer& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        auto l = lhs.peek(i);
+        auto r = rhs.peek(i);
+        if (l.kind != r.kind || l.loc.raw != r.loc.raw || l.length != r.length
+            || l.data != r.data || l.flags != r.flags) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// lexes the file serially then in parallel with 1 to jobs threads, and
+// checks that the parallel tokens are the serial ones. A small chunk size
+// puts chunk boundaries inside literals and comments.
+int runLexBench(const Args& args) {
+    if (args.empty()) {
+        std::cerr << "lex: missing input file\n";
+        return 1;
+    }
+    unsigned max_jobs = args.size() > 1 ? std::stoul(args[1]) : 4;
+    unsigned iterations = args.size() > 2 ? std::stoul(args[2]) : 5;
+    std::size_t chunk_size
+        = args.size() > 3 ? std::stoul(args[3]) : 256 * 1024;
+
+    SourceManager source_manager;
+    auto fileid = source_manager.registerFile(args[0]);
+    auto bytes = source_manager.getFileRecord(fileid)->buffer.size();
+
+    Lexer reference_lexer{&source_manager, fileid};
+    TokenBuffer reference{&reference_lexer, TokenBuffer::Mode::Eager};
+
+    Timer serial_timer;
+    for (unsigned i = 0; i < iterations; ++i) {
+        Lexer lexer{&source_manager, fileid};
+        TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+    }
+    reportRate("lex/serial", bytes * iterations, "bytes",
+               serial_timer.seconds());
+
+    int status = 0;
+    for (unsigned jobs = 1; jobs <= max_jobs; ++jobs) {
+        Timer timer;
+        for (unsigned i = 0; i < iterations; ++i) {
+            TokenBuffer tokens;
+            lexInParallel(&source_manager, fileid, jobs, &tokens, chunk_size);
+        }
+        reportRate("lex/parallel/" + std::to_string(jobs), bytes * iterations,
+                   "bytes", timer.seconds());
+
+        TokenBuffer tokens;
+        lexInParallel(&source_manager, fileid, jobs, &tokens, chunk_size);
+        if (!sameTokens(reference, tokens)) {
+            std::cerr << "lex: tokens differ with " << jobs << " jobs\n";
+            status = 1;
+        }
+    }
+    return status;
+}
+
+} // namespace bench
+} // namespace elang
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <string>
+
+#include <elang/source_manager.hpp>
+
+#include "bench.hpp"
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+// registers the file and touches every byte, so that the page faults of the
+// mapping are accounted for
+std::size_t loadOnce(const std::string& path, SourceManager::LoadMode mode,
+                     unsigned& checksum) {
+    SourceManager source_manager;
+    auto fileid = source_manager.registerFile(path, mode);
+    auto reader = source_manager.getBuffer(fileid);
+
+    std::size_t size = 0;
+    for (int c = reader.get(); c != std::char_traits<char>::eof();
+         c = reader.get()) {
+        checksum += static_cast<unsigned char>(c);
+        ++size;
+    }
+    return size;
+}
+
+} // namespace
+
+int runLoadBench(const Args& args) {
+    if (args.empty()) {
+        std::cerr << "load: missing input file\n";
+        return 1;
+    }
+    const auto& path = args[0];
+    unsigned iterations = args.size() > 1 ? std::stoul(args[1]) : 20;
+
+    struct {
+        const char* name;
+        SourceManager::LoadMode mode;
+    } modes[] = {{"load/read", SourceManager::LoadMode::Read},
+                 {"load/mmap", SourceManager::LoadMode::Map}};
+
+    for (auto& mode : modes) {
+        unsigned checksum = 0;
+        std::size_t bytes = 0;
+        Timer timer;
+        for (unsigned i = 0; i < iterations; ++i) {
+            bytes += loadOnce(path, mode.mode, checksum);
+        }
+        reportRate(mode.name, bytes, "bytes", timer.seconds());
+        if (checksum == 0 && bytes != 0) {
+            std::cerr << "load: unexpected checksum\n";
+        }
+    }
+    return 0;
+}
+
+} // namespace bench
+} // namespace elang
@@ -0,0 +1,90 @@
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "bench.hpp"
+
+namespace {
+
+bool json_output = false;
+
+struct BenchEntry {
+    const char* name;
+    const char* usage;
+    int (*run)(const elang::bench::Args&);
+};
+
+const BenchEntry benches[] = {
+    {"alloc", "alloc <file>", &elang::bench::runAllocBench},
+    {"ast", "ast [functions]", &elang::bench::runAstBench},
+    {"astbin", "astbin [functions] [iterations]",
+     &elang::bench::runAstBinBench},
+    {"flat", "flat [functions] [iterations]", &elang::bench::runFlatBench},
+    {"frontend",
+     "frontend [--functions=N] [--mod-depth=N] [--expression-length=N] "
+     "[--statements=N] [--seed=N] [--iterations=N] [--parse-jobs=N] "
+     "[--sema-jobs=N] [--emit]",
+     &elang::bench::runFrontendBench},
+    {"keywords", "keywords <file> [iterations]",
+     &elang::bench::runKeywordBench},
+    {"lazy", "lazy [functions] [iterations]", &elang::bench::runLazyBench},
+    {"lex", "lex <file> [max jobs] [iterations] [chunk size]",
+     &elang::bench::runLexBench},
+    {"load", "load <file> [iterations]", &elang::bench::runLoadBench},
+    {"scan", "scan <file> [iterations]", &elang::bench::runScanBench},
+    {"scopes", "scopes [depth] [functions] [iterations]",
+     &elang::bench::runScopeBench},
+    {"tokens", "tokens <file> [iterations]", &elang::bench::runTokenBench},
+    {"types", "types [signatures] [iterations]", &elang::bench::runTypeBench},
+};
+
+int usage() {
+    std::cerr << "usage: elang_bench [--json] <bench> [args...]\n";
+    for (auto& entry : benches) {
+        std::cerr << "    " << entry.usage << "\n";
+    }
+    return 1;
+}
+
+} // namespace
+
+namespace elang {
+namespace bench {
+
+void reportRate(const std::string& name, double amount,
+                const std::string& unit, double seconds) {
+    std::cout << std::fixed << std::setprecision(3);
+    if (json_output) {
+        std::cout << "{\"name\": \"" << name << "\", \"amount\": " << amount
+                  << ", \"unit\": \"" << unit << "\", \"seconds\": "
+                  << seconds << ", \"rate\": "
+                  << (seconds > 0 ? amount / seconds : 0) << "}" << std::endl;
+        return;
+    }
+    std::cout << name << ": " << amount << " " << unit << " in " << seconds
+              << "s (" << (seconds > 0 ? amount / seconds : 0) << " " << unit
+              << "/s)" << std::endl;
+}
+
+} // namespace bench
+} // namespace elang
+
+int main(int argc, char** argv) {
+    int first = 1;
+    if (argc > first && std::string{argv[first]} == "--json") {
+        json_output = true;
+        ++first;
+    }
+    if (argc <= first) {
+        return usage();
+    }
+
+    std::string name{argv[first]};
+    elang::bench::Args args{argv + first + 1, argv + argc};
+    for (auto& entry : benches) {
+        if (name == entry.name) {
+            return entry.run(args);
+        }
+    }
+    return usage();
+}
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <elang/char_scan.hpp>
+#include <elang/lexer.hpp>
+#include <elang/source_manager.hpp>
+
+#include "bench.hpp"
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+std::vector<Token> lexAll(SourceManager& source_manager, unsigned fileid) {
+    std::vector<Token> tokens;
+    Lexer lexer{&source_manager, fileid};
+    do {
+        tokens.push_back(lexer.getToken());
+    } while (tokens.back().isNot(Token::Kind::eof));
+    return tokens;
+}
+
+bool sameTokens(SourceManager& source_manager, const std::vector<Token>& lhs,
+                const std::vector<Token>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        if (lhs[i].kind != rhs[i].kind || lhs[i].loc.raw != rhs[i].loc.raw
+            || lhs[i].length != rhs[i].length
+            || source_manager.getTokenValue(lhs[i])
+                   != source_manager.getTokenValue(rhs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// walks the buffer with the scanners only, skipping one char at a time
+// whatever they don't handle
+std::size_t scanAll(std::string_view buffer) {
+    std::size_t pos = 0;
+    std::size_t runs = 0;
+    while (pos < buffer.size()) {
+        pos += util::skipWhiteSpaces(buffer.data() + pos, buffer.size() - pos);
+        if (pos < buffer.size() && buffer[pos] == '#') {
+            pos += util::skipToNewline(buffer.data() + pos,
+                                       buffer.size() - pos);
+        }
+        auto size = util::skipIdentifierChars(buffer.data() + pos,
+                                              buffer.size() - pos);
+        pos += size ? size : 1;
+        ++runs;
+    }
+    return runs;
+}
+
+} // namespace
+
+// lexes the file with every supported scanner implementation and checks
+// that they all produce the tokens of the scalar one
+int runScanBench(const Args& args) {
+    if (args.empty()) {
+        std::cerr << "scan: missing input file\n";
+        return 1;
+    }
+    unsigned iterations = args.size() > 1 ? std::stoul(args[1]) : 5;
+
+    SourceManager source_manager;
+    auto fileid = source_manager.registerFile(args[0]);
+    auto initial_impl = util::getScanImpl();
+
+    std::vector<Token> reference;
+    int status = 0;
+    for (auto impl : {util::ScanImpl::Scalar, util::ScanImpl::SSE2,
+                      util::ScanImpl::AVX2}) {
+        if (!util::isScanImplSupported(impl)) {
+            continue;
+        }
+        util::setScanImpl(impl);
+
+        std::vector<Token> tokens;
+        std::size_t bytes = 0;
+        Timer timer;
+        for (unsigned i = 0; i < iterations; ++i) {
+            tokens = lexAll(source_manager, fileid);
+            bytes += source_manager.getFileOffset(tokens.back().loc);
+        }
+        reportRate(std::string{"scan/"} + util::scanImplName(impl) + "/lexer",
+                   bytes, "bytes", timer.seconds());
+
+        auto buffer = source_manager.getFileRecord(fileid)->buffer;
+        std::size_t runs = 0;
+        Timer raw_timer;
+        for (unsigned i = 0; i < iterations; ++i) {
+            runs += scanAll(buffer);
+        }
+        reportRate(std::string{"scan/"} + util::scanImplName(impl) + "/raw",
+                   buffer.size() * iterations, "bytes", raw_timer.seconds());
+        if (runs == 0) {
+            std::cerr << "scan: empty input\n";
+        }
+
+        if (impl == util::ScanImpl::Scalar) {
+            reference = std::move(tokens);
+        } else if (!sameTokens(source_manager, reference, tokens)) {
+            std::cerr << "scan: " << util::scanImplName(impl)
+                      << " tokens differ from scalar ones\n";
+            status = 1;
+        }
+    }
+
+    util::setScanImpl(initial_impl);
+    return status;
+}
+
+} // namespace bench
+} // namespace elang
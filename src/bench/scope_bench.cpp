@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <elang/diagnostic.hpp>
+#include <elang/flat_sema.hpp>
+#include <elang/lexer.hpp>
+#include <elang/parser.hpp>
+#include <elang/sema_visitor.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+#include "bench.hpp"
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+// Functions made of blocks nested depth deep. Each block shadows the
+// variable of the enclosing one, declares one of its own, and reads the
+// parameter and the variables of a few enclosing blocks.
+std::string generateNestedBlocks(unsigned functions, unsigned depth) {
+    std::string out;
+    for (unsigned f = 0; f < functions; ++f) {
+        out += "func f" + std::to_string(f) + "(p : int) -> int {\n";
+        out += "let v : int = p;\n";
+        for (unsigned d = 0; d < depth; ++d) {
+            auto name = "w" + std::to_string(d);
+            auto outer = d < 3 ? std::string{"p"}
+                               : "w" + std::to_string(d - 3);
+            out += "{\n";
+            out += "let v : int = v + 1;\n";
+            out += "let " + name + " : int = v * " + outer + " - p;\n";
+        }
+        for (unsigned d = 0; d < depth; ++d) {
+            out += "}\n";
+        }
+        out += "return v;\n}\n";
+    }
+    return out;
+}
+
+} // namespace
+
+// sema on both trees, for functions with deeply nested blocks
+int runScopeBench(const Args& args) {
+    unsigned depth = args.size() > 0 ? std::stoul(args[0]) : 2000;
+    unsigned functions = args.size() > 1 ? std::stoul(args[1]) : 50;
+    unsigned iterations = args.size() > 2 ? std::stoul(args[2]) : 5;
+
+    auto program = generateNestedBlocks(functions, depth);
+    std::size_t lines = std::count(program.begin(), program.end(), '\n');
+
+    double tree_seconds = 0;
+    double flat_seconds = 0;
+    std::vector<DiagnosticEngine::Diagnostic> diagnostics;
+    DiagnosticEngine::Capture capture{&diagnostics};
+    for (unsigned i = 0; i < iterations; ++i) {
+        SourceManager source_manager;
+        auto fileid = source_manager.registerBuffer("<generated>", program);
+        Lexer lexer{&source_manager, fileid};
+        TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+
+        Parser parser{&tokens, &source_manager};
+        auto main_mod = parser.parseMainModule();
+        ast::SemaVisitor sema_visitor{&source_manager};
+        Timer timer;
+        sema_visitor.check(main_mod);
+        tree_seconds += timer.seconds();
+    }
+    for (unsigned i = 0; i < iterations; ++i) {
+        SourceManager source_manager;
+        auto fileid = source_manager.registerBuffer("<generated>", program);
+        Lexer lexer{&source_manager, fileid};
+        TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+
+        FlatParser parser{&tokens, &source_manager};
+        auto root = parser.parseMainModule();
+        auto tree = parser.getBuilder()->finish(root);
+        flat::Sema sema{&source_manager};
+        Timer timer;
+        sema.check(&tree);
+        flat_seconds += timer.seconds();
+    }
+
+    reportRate("scopes/tree/sema", lines * iterations, "lines", tree_seconds);
+    reportRate("scopes/flat/sema", lines * iterations, "lines", flat_seconds);
+    if (!diagnostics.empty()) {
+        std::cerr << "scopes: the generated program has "
+                  << diagnostics.size() << " errors" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
+} // namespace elang
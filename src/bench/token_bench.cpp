@@ -0,0 +1,64 @@
+#include <iostream>
+#include <string>
+
+#include <elang/lexer.hpp>
+#include <elang/parser.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+#include "bench.hpp"
+
+namespace elang {
+namespace bench {
+
+// parses the file with the token buffer in both modes, the eager one being
+// split between the up front lexing and the parsing
+int runTokenBench(const Args& args) {
+    if (args.empty()) {
+        std::cerr << "tokens: missing input file\n";
+        return 1;
+    }
+    unsigned iterations = args.size() > 1 ? std::stoul(args[1]) : 5;
+
+    SourceManager source_manager;
+    auto fileid = source_manager.registerFile(args[0]);
+
+    std::size_t token_count = 0;
+    double streaming_seconds = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        Lexer lexer{&source_manager, fileid};
+        TokenBuffer tokens{&lexer, TokenBuffer::Mode::Streaming};
+        Parser parser{&tokens, &source_manager};
+        Timer timer;
+        parser.parseMainModule();
+        streaming_seconds += timer.seconds();
+        token_count = tokens.size();
+        source_manager.getArena()->reset();
+    }
+    reportRate("tokens/streaming/lex+parse", token_count * iterations,
+               "tokens", streaming_seconds);
+
+    double lex_seconds = 0;
+    double parse_seconds = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        Lexer lexer{&source_manager, fileid};
+        Timer lex_timer;
+        TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+        lex_seconds += lex_timer.seconds();
+        Parser parser{&tokens, &source_manager};
+        Timer parse_timer;
+        parser.parseMainModule();
+        parse_seconds += parse_timer.seconds();
+        source_manager.getArena()->reset();
+    }
+    reportRate("tokens/eager/lex", token_count * iterations, "tokens",
+               lex_seconds);
+    reportRate("tokens/eager/parse", token_count * iterations, "tokens",
+               parse_seconds);
+    reportRate("tokens/eager/lex+parse", token_count * iterations, "tokens",
+               lex_seconds + parse_seconds);
+    return 0;
+}
+
+} // namespace bench
+} // namespace elang
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <elang/diagnostic.hpp>
+#include <elang/lexer.hpp>
+#include <elang/parser.hpp>
+#include <elang/sema_visitor.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+#include <elang/type.hpp>
+
+#include "bench.hpp"
+
+namespace elang {
+namespace bench {
+
+namespace {
+
+// the parameter types signatures are made of: the builtins, pointers to
+// them, pointers to those, and arrays of int
+constexpr unsigned pool_size = 16;
+
+std::vector<Type*> makePool(TypeManager* tm) {
+    std::vector<Type*> pool{tm->getIntType(), tm->getDoubleType(),
+                            tm->getCharType(), tm->getBoolType()};
+    for (unsigned i = 0; i < 4; ++i) {
+        pool.push_back(tm->getPointerType(pool[i]));
+    }
+    for (unsigned i = 4; i < 8; ++i) {
+        pool.push_back(tm->getPointerType(pool[i]));
+    }
+    for (unsigned size = 2; size < 6; ++size) {
+        pool.push_back(tm->getArrayType(tm->getIntType(), size));
+    }
+    return pool;
+}
+
+std::vector<std::string> makePoolSpellings() {
+    std::vector<std::string> pool{"int", "double", "char", "bool"};
+    for (unsigned i = 0; i < 4; ++i) {
+        pool.push_back("*" + pool[i]);
+    }
+    for (unsigned i = 4; i < 8; ++i) {
+        pool.push_back("*" + pool[i]);
+    }
+    for (unsigned size = 2; size < 6; ++size) {
+        pool.push_back("[int ; " + std::to_string(size) + "]");
+    }
+    return pool;
+}
+
+// Signature i takes the digits of i in base pool_size, lowest first, as
+// indices in the pool: no two signatures have the same parameters.
+std::vector<unsigned> signature(unsigned i) {
+    std::vector<unsigned> params;
+    do {
+        params.push_back(i % pool_size);
+        i /= pool_size;
+    } while (i != 0);
+    return params;
+}
+
+// one function per signature, each one declaring a local of the type of
+// its first parameter
+std::string generateSignatures(unsigned signatures) {
+    auto pool = makePoolSpellings();
+    std::string out;
+    for (unsigned i = 0; i < signatures; ++i) {
+        auto params = signature(i);
+        out += "func f" + std::to_string(i) + "(";
+        for (std::size_t j = 0; j < params.size(); ++j) {
+            if (j != 0) {
+                out += ", ";
+            }
+            out += "p" + std::to_string(j) + " : " + pool[params[j]];
+        }
+        out += ") -> void {\n";
+        out += "    let v : " + pool[params[0]] + " = p0;\n";
+        out += "}\n";
+    }
+    return out;
+}
+
+} // namespace
+
+// Uniquing of function types in the TypeManager, alone then as part of the
+// parser and sema on a program with as many distinct signatures
+int runTypeBench(const Args& args) {
+    unsigned signatures = args.size() > 0 ? std::stoul(args[0]) : 50000;
+    unsigned iterations = args.size() > 1 ? std::stoul(args[1]) : 5;
+
+    std::vector<std::vector<unsigned>> shapes;
+    for (unsigned i = 0; i < signatures; ++i) {
+        shapes.push_back(signature(i));
+    }
+
+    double make_seconds = 0;
+    double find_seconds = 0;
+    std::size_t type_bytes = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        TypeManager type_manager;
+        auto pool = makePool(&type_manager);
+        std::vector<Type*> params;
+
+        // the first pass makes every type, the second finds them again
+        for (auto* seconds : {&make_seconds, &find_seconds}) {
+            Timer timer;
+            for (auto& shape : shapes) {
+                params.clear();
+                for (auto index : shape) {
+                    params.push_back(pool[index]);
+                }
+                type_manager.getFunctionType(
+                    type_manager.getVoidType(),
+                    {params.data(), params.size()});
+            }
+            *seconds += timer.seconds();
+        }
+        type_bytes = type_manager.bytesUsed();
+    }
+
+    auto program = generateSignatures(signatures);
+    std::size_t lines = std::count(program.begin(), program.end(), '\n');
+    double frontend_seconds = 0;
+    std::vector<DiagnosticEngine::Diagnostic> diagnostics;
+    for (unsigned i = 0; i < iterations; ++i) {
+        SourceManager source_manager;
+        auto fileid = source_manager.registerBuffer("<generated>", program);
+        Lexer lexer{&source_manager, fileid};
+        TokenBuffer tokens{&lexer, TokenBuffer::Mode::Eager};
+
+        diagnostics.clear();
+        DiagnosticEngine::Capture capture{&diagnostics};
+        Timer timer;
+        Parser parser{&tokens, &source_manager};
+        auto main_mod = parser.parseMainModule();
+        ast::SemaVisitor sema_visitor{&source_manager};
+        sema_visitor.check(main_mod);
+        frontend_seconds += timer.seconds();
+    }
+
+    reportRate("types/make", signatures * iterations, "signatures",
+               make_seconds);
+    reportRate("types/find", signatures * iterations, "signatures",
+               find_seconds);
+    reportRate("types/frontend", lines * iterations, "lines",
+               frontend_seconds);
+    std::cout << "types/bytes: " << type_bytes << std::endl;
+    if (!diagnostics.empty()) {
+        std::cerr << "types: the generated program has " << diagnostics.size()
+                  << " errors" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
+} // namespace elang
@@ -0,0 +1,52 @@
+#include <elang/arena.hpp>
+
+namespace elang {
+namespace util {
+
+namespace {
+
+constexpr std::size_t block_size = 64 * 1024;
+
+} // namespace
+
+Arena::Arena() : _current(nullptr), _end(nullptr), _allocated(0), _used(0) {
+}
+
+void Arena::reset() {
+    _blocks.clear();
+    _current = _end = nullptr;
+    _allocated = _used = 0;
+}
+
+void Arena::adopt(Arena& other) {
+    for (auto& block : other._blocks) {
+        _blocks.push_back(std::move(block));
+    }
+    _allocated += other._allocated;
+    _used += other._used;
+    other._blocks.clear();
+    other._current = other._end = nullptr;
+    other._allocated = other._used = 0;
+}
+
+void* Arena::allocateSlow(std::size_t size, std::size_t alignment) {
+    // big allocations get a block of their own and keep the current one
+    auto needed = size + alignment;
+    if (needed > block_size / 4) {
+        _blocks.emplace_back(new char[needed]);
+        _allocated += needed;
+        auto address = reinterpret_cast<std::uintptr_t>(_blocks.back().get());
+        auto padding = (alignment - address % alignment) % alignment;
+        _used += size;
+        return _blocks.back().get() + padding;
+    }
+
+    _blocks.emplace_back(new char[block_size]);
+    _allocated += block_size;
+    _current = _blocks.back().get();
+    _end = _current + block_size;
+    return allocate(size, alignment);
+}
+
+} // namespace util
+} // namespace elang
@@ -2,215 +2,198 @@
 
 #include <cassert>
 
+#include <elang/ast_builder.hpp>
 #include <elang/ast_visitor.hpp>
+#include <elang/parser.hpp>
+#include <elang/source_manager.hpp>
 
 namespace elang {
 namespace ast {
 
-Node::Node(SourceLocation loc) : location(loc) {
+TreeBuilder::TreeBuilder(SourceManager* sm) : _arena(sm->getArena()) {
 }
 
-Expression::Expression(SourceLocation loc) : Node(loc) {
+Node::Node(NodeKind node_kind, SourceLocation loc)
+    : node_kind(node_kind), location(loc) {
 }
 
-BinaryOperator::BinaryOperator(BinaryOperator::Kind kind,
-                               std::unique_ptr<Expression> lhs,
-                               std::unique_ptr<Expression> rhs,
-                               SourceLocation loc)
-    : Expression(loc), kind(kind), lhs(std::move(lhs)), rhs(std::move(rhs)) {
-}
-
-bool BinaryOperator::isComputable() {
-    return lhs->isComputable() && rhs->isComputable();
+Expression::Expression(NodeKind node_kind, SourceLocation loc)
+    : Node(node_kind, loc) {
 }
 
-UnaryOperator::UnaryOperator(UnaryOperator::Kind kind,
-                             std::unique_ptr<Expression> expr,
-                             SourceLocation loc)
-    : Expression(loc), kind(kind), expr(std::move(expr)) {
+bool Expression::isComputable() const {
+    switch (node_kind) {
+    case NodeKind::BinaryOperator: {
+        auto op = static_cast<const BinaryOperator*>(this);
+        return op->lhs->isComputable() && op->rhs->isComputable();
+    }
+    case NodeKind::UnaryOperator:
+        return static_cast<const UnaryOperator*>(this)->expr->isComputable();
+    case NodeKind::SubscriptExpression: {
+        auto subscript = static_cast<const SubscriptExpression*>(this);
+        return subscript->subscripted->isComputable()
+               && subscript->index->isComputable();
+    }
+    case NodeKind::CastExpression:
+        return static_cast<const CastExpression*>(this)
+            ->casted->isComputable();
+    case NodeKind::LValueToRValueCastExpression:
+        return static_cast<const LValueToRValueCastExpression*>(this)
+            ->lvalue->isComputable();
+    case NodeKind::IntLiteral:
+    case NodeKind::DoubleLiteral:
+    case NodeKind::CharLiteral:
+    case NodeKind::StringLiteral:
+    case NodeKind::BoolLiteral:
+        return true;
+    default:
+        return false;
+    }
 }
 
-bool UnaryOperator::isComputable() {
-    return expr->isComputable();
+BinaryOperator::BinaryOperator(BinaryOperator::Kind kind, Expression* lhs,
+                               Expression* rhs, SourceLocation loc)
+    : Expression(NodeKind::BinaryOperator, loc), kind(kind), lhs(lhs),
+      rhs(rhs) {
 }
 
-SubscriptExpression::SubscriptExpression(
-    std::unique_ptr<Expression> subscripted, std::unique_ptr<Expression> index,
-    SourceLocation loc)
-    : Expression(loc), subscripted(std::move(subscripted)),
-      index(std::move(index)) {
+UnaryOperator::UnaryOperator(UnaryOperator::Kind kind, Expression* expr,
+                             SourceLocation loc)
+    : Expression(NodeKind::UnaryOperator, loc), kind(kind), expr(expr) {
 }
 
-bool SubscriptExpression::isComputable() {
-    return subscripted->isComputable() && index->isComputable();
+SubscriptExpression::SubscriptExpression(Expression* subscripted,
+                                         Expression* index, SourceLocation loc)
+    : Expression(NodeKind::SubscriptExpression, loc), subscripted(subscripted),
+      index(index) {
 }
 
-CallExpression::CallExpression(std::unique_ptr<IdentifierReference> func,
-                               std::vector<std::unique_ptr<Expression>> args,
+CallExpression::CallExpression(IdentifierReference* func,
+                               util::Span<Expression*> args,
                                SourceLocation loc)
-    : Expression(loc), func(std::move(func)), args(std::move(args)) {
-}
-
-bool CallExpression::isComputable() {
-    return false;
+    : Expression(NodeKind::CallExpression, loc), func(func), args(args) {
 }
 
-CastExpression::CastExpression(std::unique_ptr<Expression> casted,
-                               Type* to_type, SourceLocation loc)
-    : Expression(loc), casted(std::move(casted)), to_type(to_type) {
-}
-
-bool CastExpression::isComputable() {
-    return casted->isComputable();
-}
-
-LValueToRValueCastExpression::LValueToRValueCastExpression(
-    std::unique_ptr<Expression> lvalue, SourceLocation loc)
-    : Expression(loc), lvalue(std::move(lvalue)) {
+CastExpression::CastExpression(Expression* casted, Type* to_type,
+                               SourceLocation loc)
+    : Expression(NodeKind::CastExpression, loc), casted(casted),
+      to_type(to_type) {
 }
 
-bool LValueToRValueCastExpression::isComputable() {
-    return lvalue->isComputable();
+LValueToRValueCastExpression::LValueToRValueCastExpression(Expression* lvalue,
+                                                           SourceLocation loc)
+    : Expression(NodeKind::LValueToRValueCastExpression, loc), lvalue(lvalue) {
 }
 
-IdentifierReference::IdentifierReference(std::string name,
-                                         std::vector<std::string> module_path,
+IdentifierReference::IdentifierReference(Symbol name,
+                                         util::Span<Symbol> module_path,
                                          SourceLocation loc)
-    : Expression(loc), name(name), module_path(std::move(module_path)) {
-}
-
-bool IdentifierReference::isComputable() {
-    return false;
+    : Expression(NodeKind::IdentifierReference, loc), name(name),
+      module_path(module_path) {
 }
 
 IntLiteral::IntLiteral(unsigned long value, SourceLocation loc)
-    : Expression(loc), value(value) {
-}
-
-bool IntLiteral::isComputable() {
-    return true;
+    : Expression(NodeKind::IntLiteral, loc), value(value) {
 }
 
 DoubleLiteral::DoubleLiteral(double value, SourceLocation loc)
-    : Expression(loc), value(value) {
-}
-
-bool DoubleLiteral::isComputable() {
-    return true;
+    : Expression(NodeKind::DoubleLiteral, loc), value(value) {
 }
 
 CharLiteral::CharLiteral(char value, SourceLocation loc)
-    : Expression(loc), value(value) {
+    : Expression(NodeKind::CharLiteral, loc), value(value) {
 }
 
-bool CharLiteral::isComputable() {
-    return true;
-}
-
-StringLiteral::StringLiteral(std::string value, SourceLocation loc)
-    : Expression(loc), value(value) {
-}
-
-bool StringLiteral::isComputable() {
-    return true;
+StringLiteral::StringLiteral(std::string_view value, SourceLocation loc)
+    : Expression(NodeKind::StringLiteral, loc), value(value) {
 }
 
 BoolLiteral::BoolLiteral(bool value, SourceLocation loc)
-    : Expression(loc), value(value) {
-}
-
-bool BoolLiteral::isComputable() {
-    return true;
+    : Expression(NodeKind::BoolLiteral, loc), value(value) {
 }
 
-Statement::Statement(SourceLocation loc) : Node(loc) {
+Statement::Statement(NodeKind node_kind, SourceLocation loc)
+    : Node(node_kind, loc) {
 }
 
-CompoundStatement::CompoundStatement(
-    std::vector<std::unique_ptr<Statement>> stmts, SourceLocation loc)
-    : Statement(loc), stmts(std::move(stmts)) {
+CompoundStatement::CompoundStatement(util::Span<Statement*> stmts,
+                                     SourceLocation loc)
+    : Statement(NodeKind::CompoundStatement, loc), stmts(stmts) {
 }
 
-LetStatement::LetStatement(Type* type, std::string name,
-                           std::unique_ptr<ast::Expression> init_expr,
+LetStatement::LetStatement(Type* type, Symbol name, ast::Expression* init_expr,
                            SourceLocation loc)
-    : Statement(loc), type(type), name(std::move(name)),
-      init_expr(std::move(init_expr)) {
+    : Statement(NodeKind::LetStatement, loc), type(type), name(name),
+      init_expr(init_expr) {
 }
 
-ExpressionStatement::ExpressionStatement(std::unique_ptr<Expression> expr,
-                                         SourceLocation loc)
-    : Statement(loc), expr(std::move(expr)) {
+ExpressionStatement::ExpressionStatement(Expression* expr, SourceLocation loc)
+    : Statement(NodeKind::ExpressionStatement, loc), expr(expr) {
 }
 
 SelectionStatement::SelectionStatement(
-    std::vector<std::pair<std::unique_ptr<Expression>,
-                          std::unique_ptr<CompoundStatement>>> choices,
-    std::unique_ptr<CompoundStatement> else_stmt, SourceLocation loc)
-    : Statement(loc), choices(std::move(choices)),
-      else_stmt(std::move(else_stmt)) {
+    util::Span<std::pair<Expression*, CompoundStatement*>> choices,
+    CompoundStatement* else_stmt, SourceLocation loc)
+    : Statement(NodeKind::SelectionStatement, loc), choices(choices),
+      else_stmt(else_stmt) {
 }
 
-IterationStatement::IterationStatement(std::unique_ptr<Expression> condition,
-                                       std::unique_ptr<CompoundStatement> stmt,
+IterationStatement::IterationStatement(Expression* condition,
+                                       CompoundStatement* stmt,
                                        SourceLocation loc)
-    : Statement(loc), condition(std::move(condition)), stmt(std::move(stmt)) {
+    : Statement(NodeKind::IterationStatement, loc), condition(condition),
+      stmt(stmt) {
 }
 
-ReturnStatement::ReturnStatement(std::unique_ptr<Expression> expr,
-                                 SourceLocation loc)
-    : Statement(loc), expr(std::move(expr)) {
+ReturnStatement::ReturnStatement(Expression* expr, SourceLocation loc)
+    : Statement(NodeKind::ReturnStatement, loc), expr(expr) {
 }
 
-Declaration::Declaration(SourceLocation loc) : Node(loc) {
+Declaration::Declaration(NodeKind node_kind, SourceLocation loc)
+    : Node(node_kind, loc) {
 }
 
-FunctionDeclaration::FunctionDeclaration(std::string name, FunctionType* type,
+FunctionDeclaration::FunctionDeclaration(Symbol name, FunctionType* type,
                                          SourceLocation loc)
-    : Declaration(loc), name(std::move(name)), type(type) {
+    : FunctionDeclaration(NodeKind::FunctionDeclaration, name, type, loc) {
+}
+
+FunctionDeclaration::FunctionDeclaration(NodeKind node_kind, Symbol name,
+                                         FunctionType* type,
+                                         SourceLocation loc)
+    : Declaration(node_kind, loc), name(name), type(type) {
 }
 
 FunctionDefinition::FunctionDefinition(
-    std::string name, FunctionType* type, std::vector<std::string> param_names,
-    std::unique_ptr<CompoundStatement> content_stmt, SourceLocation loc)
-    : FunctionDeclaration(name, type, loc), param_names(std::move(param_names)),
-      content_stmt(std::move(content_stmt)) {
+    Symbol name, FunctionType* type, util::Span<Symbol> param_names,
+    CompoundStatement* content_stmt, SourceLocation loc)
+    : FunctionDeclaration(NodeKind::FunctionDefinition, name, type, loc),
+      param_names(param_names), content_stmt(content_stmt), loader(nullptr),
+      body_token(0) {
     assert(type->params_types.size() == this->param_names.size());
 }
 
-Module::Module(std::string name,
-               std::vector<std::unique_ptr<Declaration>> declarations,
-               SourceLocation loc)
-    : Declaration(loc), name(name), declarations(std::move(declarations)) {
+FunctionDefinition::FunctionDefinition(
+    Symbol name, FunctionType* type, util::Span<Symbol> param_names,
+    BodyLoader* loader, std::uint32_t body_token, SourceLocation loc)
+    : FunctionDeclaration(NodeKind::FunctionDefinition, name, type, loc),
+      param_names(param_names), content_stmt(nullptr), loader(loader),
+      body_token(body_token) {
+    assert(type->params_types.size() == this->param_names.size());
 }
 
-/* generation of visitors accept functions */
-#define GENERATE_VISITOR(cls)                                                  \
-    void cls::accept(Visitor* visitor) {                                       \
-        visitor->visit(this);                                                  \
+CompoundStatement* FunctionDefinition::content() {
+    if (!content_stmt) {
+        content_stmt = loader->load(body_token);
     }
+    return content_stmt;
+}
 
-GENERATE_VISITOR(BinaryOperator)
-GENERATE_VISITOR(UnaryOperator)
-GENERATE_VISITOR(SubscriptExpression)
-GENERATE_VISITOR(CallExpression)
-GENERATE_VISITOR(CastExpression)
-GENERATE_VISITOR(LValueToRValueCastExpression)
-GENERATE_VISITOR(IdentifierReference)
-GENERATE_VISITOR(IntLiteral)
-GENERATE_VISITOR(DoubleLiteral)
-GENERATE_VISITOR(CharLiteral)
-GENERATE_VISITOR(StringLiteral)
-GENERATE_VISITOR(BoolLiteral)
-GENERATE_VISITOR(CompoundStatement)
-GENERATE_VISITOR(LetStatement)
-GENERATE_VISITOR(ExpressionStatement)
-GENERATE_VISITOR(SelectionStatement)
-GENERATE_VISITOR(IterationStatement)
-GENERATE_VISITOR(ReturnStatement)
-GENERATE_VISITOR(FunctionDeclaration)
-GENERATE_VISITOR(FunctionDefinition)
-GENERATE_VISITOR(Module)
+Module::Module(Symbol name, util::Span<Declaration*> declarations,
+               SourceLocation loc)
+    : Declaration(NodeKind::Module, loc), name(name),
+      declarations(declarations) {
+}
 
 } // namespace ast
 } // namespace elang
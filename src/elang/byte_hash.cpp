@@ -0,0 +1,31 @@
+#include <elang/byte_hash.hpp>
+
+#include <cstring>
+
+namespace elang {
+namespace util {
+
+std::uint64_t hashBytes(std::uint64_t hash, const void* data,
+                        std::size_t size) {
+    constexpr std::uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+    auto mix = [&](std::uint64_t word) {
+        hash = ((hash << 23 | hash >> 41) ^ word) * multiplier;
+    };
+    auto bytes = static_cast<const char*>(data);
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof word);
+        mix(word);
+    }
+    std::uint64_t tail = 0;
+    if (i < size) {
+        std::memcpy(&tail, bytes + i, size - i);
+    }
+    mix(tail);
+    mix(size);
+    return hash ^ (hash >> 29);
+}
+
+} // namespace util
+} // namespace elang
@@ -0,0 +1,292 @@
+#include <elang/char_scan.hpp>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ELANG_SCAN_X86
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace elang {
+namespace util {
+
+void collectLineStarts(std::string_view buffer,
+                       std::vector<std::uint32_t>& line_starts) {
+    const char* data = buffer.data();
+    std::size_t size = buffer.size();
+    std::size_t i = 0;
+
+    line_starts.reserve(line_starts.size() + size / 32 + 1);
+    line_starts.push_back(0);
+
+#ifdef __SSE2__
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16) {
+        auto chunk
+            = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        while (mask) {
+            line_starts.push_back(i + __builtin_ctz(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i < size; ++i) {
+        if (data[i] == '\n') {
+            line_starts.push_back(i + 1);
+        }
+    }
+}
+
+namespace {
+
+// Each scan describes the set of skipped chars for every implementation.
+// The vector versions return a bit mask of the skipped chars.
+
+struct WhiteSpaceScan {
+    static bool scalar(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+    }
+
+#ifdef ELANG_SCAN_X86
+    static unsigned sse2(__m128i c) {
+        auto spaces = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')),
+                         _mm_cmpeq_epi8(c, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('\t')),
+                         _mm_cmpeq_epi8(c, _mm_set1_epi8('\r'))));
+        return _mm_movemask_epi8(spaces);
+    }
+
+    __attribute__((target("avx2"))) static unsigned avx2(__m256i c) {
+        auto spaces = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\t')),
+                            _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\r'))));
+        return _mm256_movemask_epi8(spaces);
+    }
+#endif
+};
+
+struct NotNewlineScan {
+    static bool scalar(char c) {
+        return c != '\n';
+    }
+
+#ifdef ELANG_SCAN_X86
+    static unsigned sse2(__m128i c) {
+        return ~_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8('\n')))
+               & 0xFFFFu;
+    }
+
+    __attribute__((target("avx2"))) static unsigned avx2(__m256i c) {
+        return ~_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n')));
+    }
+#endif
+};
+
+struct IdentifierScan {
+    static bool scalar(char c) {
+        return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z')
+               || ('0' <= c && c <= '9') || c == '_';
+    }
+
+#ifdef ELANG_SCAN_X86
+    // bytes >= 0x80 are negative for the signed comparisons, so they never
+    // fall in a range
+    static unsigned sse2(__m128i c) {
+        auto lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+        auto alpha
+            = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                            _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+        auto digit
+            = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                            _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+        auto underscore = _mm_cmpeq_epi8(c, _mm_set1_epi8('_'));
+        return _mm_movemask_epi8(
+            _mm_or_si128(_mm_or_si128(alpha, digit), underscore));
+    }
+
+    __attribute__((target("avx2"))) static unsigned avx2(__m256i c) {
+        auto lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+        auto alpha = _mm256_and_si256(
+            _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+        auto digit = _mm256_and_si256(
+            _mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+        auto underscore = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_'));
+        return _mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_or_si256(alpha, digit), underscore));
+    }
+#endif
+};
+
+template <class Scan>
+std::size_t scalarSkip(const char* data, std::size_t size, std::size_t i = 0) {
+    while (i < size && Scan::scalar(data[i])) {
+        ++i;
+    }
+    return i;
+}
+
+// Most runs (indentation, identifiers) are short: the first chars are
+// checked one by one and the vector loop only starts after them.
+constexpr std::size_t scalar_prefix = 8;
+
+template <class Scan>
+bool scalarPrefix(const char* data, std::size_t size, std::size_t& i) {
+    auto limit = size < scalar_prefix ? size : scalar_prefix;
+    while (i < limit) {
+        if (!Scan::scalar(data[i])) {
+            return true;
+        }
+        ++i;
+    }
+    return i == size;
+}
+
+#ifdef ELANG_SCAN_X86
+template <class Scan>
+std::size_t sse2Skip(const char* data, std::size_t size) {
+    std::size_t i = 0;
+    if (scalarPrefix<Scan>(data, size, i)) {
+        return i;
+    }
+    for (; i + 16 <= size; i += 16) {
+        auto chunk
+            = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned stop = ~Scan::sse2(chunk) & 0xFFFFu;
+        if (stop) {
+            return i + __builtin_ctz(stop);
+        }
+    }
+    return scalarSkip<Scan>(data, size, i);
+}
+
+template <class Scan>
+__attribute__((target("avx2"))) std::size_t avx2Skip(const char* data,
+                                                     std::size_t size) {
+    std::size_t i = 0;
+    if (scalarPrefix<Scan>(data, size, i)) {
+        return i;
+    }
+    for (; i + 32 <= size; i += 32) {
+        auto chunk
+            = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        unsigned stop = ~Scan::avx2(chunk);
+        if (stop) {
+            return i + __builtin_ctz(stop);
+        }
+    }
+    return scalarSkip<Scan>(data, size, i);
+}
+#endif
+
+struct Scanners {
+    std::size_t (*white_spaces)(const char*, std::size_t);
+    std::size_t (*to_newline)(const char*, std::size_t);
+    std::size_t (*identifier_chars)(const char*, std::size_t);
+};
+
+template <class Scan>
+std::size_t scalarScanner(const char* data, std::size_t size) {
+    return scalarSkip<Scan>(data, size);
+}
+
+const Scanners scalar_scanners{&scalarScanner<WhiteSpaceScan>,
+                               &scalarScanner<NotNewlineScan>,
+                               &scalarScanner<IdentifierScan>};
+
+#ifdef ELANG_SCAN_X86
+const Scanners sse2_scanners{&sse2Skip<WhiteSpaceScan>,
+                             &sse2Skip<NotNewlineScan>,
+                             &sse2Skip<IdentifierScan>};
+
+const Scanners avx2_scanners{&avx2Skip<WhiteSpaceScan>,
+                             &avx2Skip<NotNewlineScan>,
+                             &avx2Skip<IdentifierScan>};
+#endif
+
+const Scanners& scannersFor(ScanImpl impl) {
+    switch (impl) {
+#ifdef ELANG_SCAN_X86
+    case ScanImpl::SSE2:
+        return sse2_scanners;
+    case ScanImpl::AVX2:
+        return avx2_scanners;
+#endif
+    default:
+        return scalar_scanners;
+    }
+}
+
+ScanImpl detectScanImpl() {
+    if (isScanImplSupported(ScanImpl::AVX2)) {
+        return ScanImpl::AVX2;
+    } else if (isScanImplSupported(ScanImpl::SSE2)) {
+        return ScanImpl::SSE2;
+    }
+    return ScanImpl::Scalar;
+}
+
+ScanImpl current_impl = detectScanImpl();
+const Scanners* current_scanners = &scannersFor(current_impl);
+
+} // namespace
+
+bool isScanImplSupported(ScanImpl impl) {
+    switch (impl) {
+    case ScanImpl::Scalar:
+        return true;
+#ifdef ELANG_SCAN_X86
+    case ScanImpl::SSE2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+    case ScanImpl::AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+ScanImpl getScanImpl() {
+    return current_impl;
+}
+
+void setScanImpl(ScanImpl impl) {
+    current_impl = impl;
+    current_scanners = &scannersFor(impl);
+}
+
+const char* scanImplName(ScanImpl impl) {
+    switch (impl) {
+    case ScanImpl::Scalar:
+        return "scalar";
+    case ScanImpl::SSE2:
+        return "sse2";
+    case ScanImpl::AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+std::size_t skipWhiteSpaces(const char* data, std::size_t size) {
+    return current_scanners->white_spaces(data, size);
+}
+
+std::size_t skipToNewline(const char* data, std::size_t size) {
+    return current_scanners->to_newline(data, size);
+}
+
+std::size_t skipIdentifierChars(const char* data, std::size_t size) {
+    return current_scanners->identifier_chars(data, size);
+}
+
+} // namespace util
+} // namespace elang
@@ -4,6 +4,8 @@
 #include <ostream>
 #include <string>
 
+#include <elang/source_manager.hpp>
+
 namespace elang {
 namespace ast {
 
@@ -55,6 +57,10 @@ std::ostream& operator<<(std::ostream& out, UnaryOperator::Kind kind) {
     }
 }
 
+DebugVisitor::DebugVisitor(SourceManager* sm, bool print_bodies)
+    : _interner(sm->getInterner()), _print_bodies(print_bodies) {
+}
+
 void DebugVisitor::increaseTab() {
     current_tab += "    ";
 }
@@ -67,30 +73,30 @@ void DebugVisitor::decreaseTab() {
 
 void DebugVisitor::visit(BinaryOperator* node) {
     std::cout << "(";
-    node->lhs->accept(this);
+    dispatch(node->lhs);
     std::cout << " " << node->kind << " ";
-    node->rhs->accept(this);
+    dispatch(node->rhs);
     std::cout << ")";
 }
 
 void DebugVisitor::visit(UnaryOperator* node) {
     std::cout << "(" << node->kind;
-    node->expr->accept(this);
+    dispatch(node->expr);
     std::cout << ")";
 }
 
 void DebugVisitor::visit(SubscriptExpression* node) {
     std::cout << "(";
-    node->subscripted->accept(this);
+    dispatch(node->subscripted);
     std::cout << ")";
     std::cout << "[";
-    node->index->accept(this);
+    dispatch(node->index);
     std::cout << "]";
     return;
 }
 
 void DebugVisitor::visit(CallExpression* node) {
-    node->func->accept(this);
+    dispatch(node->func);
     std::cout << "(";
 
     bool first_arg = true;
@@ -100,27 +106,27 @@ void DebugVisitor::visit(CallExpression* node) {
         } else {
             std::cout << ", ";
         }
-        arg->accept(this);
+        dispatch(arg);
     }
     std::cout << ")";
 }
 
 void DebugVisitor::visit(CastExpression* node) {
     std::cout << "(";
-    node->casted->accept(this);
+    dispatch(node->casted);
     std::cout << " as " << node->to_type->toString() << ")";
 }
 
 void DebugVisitor::visit(LValueToRValueCastExpression* node) {
     std::cout << "(";
-    node->lvalue->accept(this);
+    dispatch(node->lvalue);
     std::cout << " to rvalue)";
 }
 
 void DebugVisitor::visit(IdentifierReference* node) {
-    for (auto& str : node->module_path)
-        std::cout << str << " :: ";
-    std::cout << node->name;
+    for (auto sym : node->module_path)
+        std::cout << _interner->get(sym) << " :: ";
+    std::cout << _interner->get(node->name);
 }
 
 void DebugVisitor::visit(IntLiteral* node) {
@@ -147,7 +153,7 @@ void DebugVisitor::visit(CompoundStatement* node) {
     std::cout << current_tab << "{\n";
     increaseTab();
     for (auto& stmt : node->stmts) {
-        stmt->accept(this);
+        dispatch(stmt);
         std::cout << "\n";
     }
     decreaseTab();
@@ -155,14 +161,14 @@ void DebugVisitor::visit(CompoundStatement* node) {
 }
 
 void DebugVisitor::visit(LetStatement* node) {
-    std::cout << current_tab << "let " << node->name;
+    std::cout << current_tab << "let " << _interner->get(node->name);
 
     if (node->type) {
         std::cout << " : " << node->type->toString();
     }
     if (node->init_expr) {
         std::cout << " = ";
-        node->init_expr->accept(this);
+        dispatch(node->init_expr);
     }
     std::cout << ";";
 }
@@ -170,7 +176,7 @@ void DebugVisitor::visit(LetStatement* node) {
 void DebugVisitor::visit(ExpressionStatement* node) {
     std::cout << current_tab;
     if (node->expr) {
-        node->expr->accept(this);
+        dispatch(node->expr);
     }
     std::cout << ";";
 }
@@ -184,39 +190,40 @@ void DebugVisitor::visit(SelectionStatement* node) {
         } else {
             std::cout << current_tab << "else if";
         }
-        choice.first->accept(this);
+        dispatch(choice.first);
         std::cout << "\n";
-        choice.second->accept(this);
+        dispatch(choice.second);
     }
 
     if (node->else_stmt) {
         std::cout << current_tab << "else\n";
-        node->else_stmt->accept(this);
+        dispatch(node->else_stmt);
     }
 }
 
 void DebugVisitor::visit(IterationStatement* node) {
     std::cout << current_tab << "while ";
-    node->condition->accept(this);
+    dispatch(node->condition);
     std::cout << "\n";
-    node->stmt->accept(this);
+    dispatch(node->stmt);
 }
 
 void DebugVisitor::visit(ReturnStatement* node) {
     std::cout << current_tab << "return";
     if (node->expr) {
         std::cout << " ";
-        node->expr->accept(this);
+        dispatch(node->expr);
     }
     std::cout << ";";
 }
 
 void DebugVisitor::visit(FunctionDeclaration* node) {
-    std::cout << "func " << node->name << " " << node->type->toString();
+    std::cout << "func " << _interner->get(node->name) << " "
+              << node->type->toString();
 }
 
 void DebugVisitor::visit(FunctionDefinition* node) {
-    std::cout << "func " << node->name;
+    std::cout << "func " << _interner->get(node->name);
     std::cout << "(";
 
     bool first_param = true;
@@ -226,19 +233,22 @@ void DebugVisitor::visit(FunctionDefinition* node) {
         } else {
             std::cout << ", ";
         }
-        std::cout << node->param_names[i] << " : "
+        std::cout << _interner->get(node->param_names[i]) << " : "
                   << node->type->params_types[i]->toString();
     }
     std::cout << ") -> " << node->type->return_type->toString();
+    if (!_print_bodies) {
+        return;
+    }
 
     std::cout << "\n";
-    node->content_stmt->accept(this);
+    dispatch(node->content());
 }
 
 void DebugVisitor::visit(Module* node) {
-    std::cout << ">>> module " << node->name << "\n";
+    std::cout << ">>> module " << _interner->get(node->name) << "\n";
     for (auto& decl : node->declarations) {
-        decl->accept(this);
+        dispatch(decl);
         std::cout << "\n";
     }
 }
@@ -9,18 +9,51 @@
 std::string getMessage(unsigned error_index);
 std::vector<std::string> splitMessage(std::string msg);
 std::string buildMessage(unsigned error_index,
-                         std::initializer_list<std::string> params);
+                         const std::vector<std::string>& params);
 
 namespace elang {
 
+namespace {
+
+thread_local std::vector<DiagnosticEngine::Diagnostic>* capture_sink
+    = nullptr;
+thread_local unsigned capture_limit = 0;
+
+} // namespace
+
+DiagnosticEngine::Capture::Capture(std::vector<Diagnostic>* sink,
+                                   unsigned limit)
+    : _previous(capture_sink), _previous_limit(capture_limit) {
+    capture_sink = sink;
+    capture_limit = limit;
+}
+
+DiagnosticEngine::Capture::~Capture() {
+    capture_sink = _previous;
+    capture_limit = _previous_limit;
+}
+
 DiagnosticEngine::DiagnosticEngine(SourceManager* sm, unsigned limit)
     : _source_manager(sm), _limit(limit), _nerr(0) {
 }
 
-void DiagnosticEngine::report(SourceLocation loc, unsigned error_index,
-                              std::initializer_list<std::string> params) {
-    auto message = buildMessage(error_index, params);
-    auto user_loc = _source_manager->getUserLocation(loc);
+void DiagnosticEngine::report(const std::vector<Diagnostic>& diagnostics) {
+    for (auto& diagnostic : diagnostics) {
+        report(diagnostic);
+    }
+}
+
+void DiagnosticEngine::report(Diagnostic diagnostic) {
+    if (capture_sink) {
+        capture_sink->push_back(std::move(diagnostic));
+        if (capture_limit && capture_sink->size() >= capture_limit) {
+            throw CaptureAborted{};
+        }
+        return;
+    }
+
+    auto message = buildMessage(diagnostic.error_index, diagnostic.params);
+    auto user_loc = _source_manager->getUserLocation(diagnostic.location);
     std::cout << user_loc.file_name << ":" << user_loc.line << ":"
               << user_loc.column << ": " << red_color
               << "Error :" << normal_color << " " << message << "\n";
@@ -68,7 +101,7 @@ std::vector<std::string> splitMessage(std::string msg) {
 }
 
 std::string buildMessage(unsigned error_index,
-                         std::initializer_list<std::string> params) {
+                         const std::vector<std::string>& params) {
     auto template_message = getMessage(error_index);
     auto split_msg = splitMessage(template_message);
     assert(split_msg.size() - 1 == params.size());
@@ -0,0 +1,269 @@
+#include <elang/flat_ast.hpp>
+
+#include <elang/type.hpp>
+
+namespace elang {
+namespace flat {
+
+std::size_t Tree::bytesUsed() const {
+    // a mapped tree only pulls in the pages it touches, count the whole
+    // arrays all the same
+    std::size_t bytes = (_type_table.capacity() + _types.capacity())
+                        * sizeof(Type*);
+    if (_arrays) {
+#define FLAT_ARRAY(T, name) bytes += _arrays->name.capacity() * sizeof(T);
+#include <elang/flat_arrays.def>
+    } else {
+#define FLAT_ARRAY(T, name) bytes += _##name.size() * sizeof(T);
+#include <elang/flat_arrays.def>
+    }
+    return bytes;
+}
+
+Builder::Builder(SourceManager*) : _arrays(std::make_unique<TreeArrays>()) {
+}
+
+void Builder::reserve(std::size_t tokens) {
+    _arrays->nodes.reserve(tokens);
+    _arrays->locations.reserve(tokens);
+}
+
+NodeIndex Builder::binaryOperator(ast::BinaryOperator::Kind kind,
+                                  NodeIndex lhs, NodeIndex rhs,
+                                  SourceLocation loc) {
+    return add(NodeKind::BinaryOperator, _arrays->binary_operators,
+               {kind, lhs, rhs}, loc);
+}
+
+NodeIndex Builder::unaryOperator(ast::UnaryOperator::Kind kind,
+                                 NodeIndex expr, SourceLocation loc) {
+    return add(NodeKind::UnaryOperator, _arrays->unary_operators, {kind, expr},
+               loc);
+}
+
+NodeIndex Builder::subscriptExpression(NodeIndex subscripted, NodeIndex index,
+                                       SourceLocation loc) {
+    return add(NodeKind::SubscriptExpression, _arrays->subscript_expressions,
+               {subscripted, index}, loc);
+}
+
+NodeIndex Builder::callExpression(NodeIndex func,
+                                  util::Span<const NodeIndex> args,
+                                  SourceLocation loc) {
+    return add(NodeKind::CallExpression, _arrays->call_expressions,
+               {func, addNodes(args)}, loc);
+}
+
+NodeIndex Builder::castExpression(NodeIndex casted, Type* to_type,
+                                  SourceLocation loc) {
+    return add(NodeKind::CastExpression, _arrays->cast_expressions,
+               {casted, addType(to_type)}, loc);
+}
+
+NodeIndex Builder::identifierReference(Symbol name,
+                                       util::Span<const Symbol> module_path,
+                                       SourceLocation loc) {
+    return add(NodeKind::IdentifierReference, _arrays->identifier_references,
+               {name, addSymbols(module_path)}, loc);
+}
+
+NodeIndex Builder::intLiteral(unsigned long value, SourceLocation loc) {
+    return add(NodeKind::IntLiteral, _arrays->int_literals,
+               std::uint64_t{value}, loc);
+}
+
+NodeIndex Builder::doubleLiteral(double value, SourceLocation loc) {
+    return add(NodeKind::DoubleLiteral, _arrays->double_literals, value, loc);
+}
+
+NodeIndex Builder::charLiteral(char value, SourceLocation loc) {
+    return add(NodeKind::CharLiteral, _arrays->char_literals, value, loc);
+}
+
+NodeIndex Builder::stringLiteral(std::string_view value, SourceLocation loc) {
+    List chars{static_cast<std::uint32_t>(_arrays->chars.size()),
+               static_cast<std::uint32_t>(value.size())};
+    _arrays->chars.insert(_arrays->chars.end(), value.begin(), value.end());
+    return add(NodeKind::StringLiteral, _arrays->string_literals, chars, loc);
+}
+
+NodeIndex Builder::boolLiteral(bool value, SourceLocation loc) {
+    return add(NodeKind::BoolLiteral, _arrays->bool_literals,
+               std::uint8_t{value}, loc);
+}
+
+NodeIndex Builder::selectionCondition(NodeIndex condition,
+                                      SourceLocation loc) {
+    return add(NodeKind::SelectionCondition, _arrays->conditions, {condition},
+               loc);
+}
+
+NodeIndex Builder::iterationCondition(NodeIndex condition,
+                                      SourceLocation loc) {
+    return add(NodeKind::IterationCondition, _arrays->conditions, {condition},
+               loc);
+}
+
+void Builder::beginCompoundStatement(SourceLocation loc) {
+    _open_begins.push_back(
+        add(NodeKind::BlockBegin, _arrays->block_begins, {no_node}, loc));
+}
+
+NodeIndex Builder::compoundStatement(util::Span<const NodeIndex> stmts,
+                                     SourceLocation loc) {
+    auto begin = closeBegin();
+    auto node = add(NodeKind::CompoundStatement, _arrays->compound_statements,
+                    {begin, addNodes(stmts)}, loc);
+    _arrays->block_begins[_arrays->nodes[begin].payload].end = node;
+    return node;
+}
+
+NodeIndex Builder::letStatement(Type* type, Symbol name, NodeIndex init_expr,
+                                SourceLocation loc) {
+    return add(NodeKind::LetStatement, _arrays->let_statements,
+               {addType(type), name, init_expr}, loc);
+}
+
+NodeIndex Builder::expressionStatement(NodeIndex expr, SourceLocation loc) {
+    return add(NodeKind::ExpressionStatement, _arrays->expression_statements,
+               {expr}, loc);
+}
+
+NodeIndex Builder::selectionStatement(
+    util::Span<const std::pair<NodeIndex, NodeIndex>> choices,
+    NodeIndex else_stmt, SourceLocation loc) {
+    List list{static_cast<std::uint32_t>(_arrays->node_lists.size()),
+              static_cast<std::uint32_t>(choices.size() * 2)};
+    for (auto& choice : choices) {
+        _arrays->node_lists.push_back(choice.first);
+        _arrays->node_lists.push_back(choice.second);
+    }
+    return add(NodeKind::SelectionStatement, _arrays->selection_statements,
+               {list, else_stmt}, loc);
+}
+
+NodeIndex Builder::iterationStatement(NodeIndex condition, NodeIndex stmt,
+                                      SourceLocation loc) {
+    return add(NodeKind::IterationStatement, _arrays->iteration_statements,
+               {condition, stmt}, loc);
+}
+
+NodeIndex Builder::returnStatement(NodeIndex expr, SourceLocation loc) {
+    return add(NodeKind::ReturnStatement, _arrays->return_statements, {expr},
+               loc);
+}
+
+NodeIndex Builder::functionDeclaration(Symbol name, FunctionType* type,
+                                       SourceLocation loc) {
+    return add(NodeKind::FunctionDeclaration, _arrays->function_declarations,
+               {name, addType(type)}, loc);
+}
+
+void Builder::beginFunctionDefinition(Symbol name, FunctionType* type,
+                                      util::Span<const Symbol> param_names,
+                                      SourceLocation loc) {
+    _open_begins.push_back(
+        add(NodeKind::FunctionBegin, _arrays->function_begins,
+            {name, addType(type), addSymbols(param_names), no_node}, loc));
+}
+
+NodeIndex Builder::functionDefinition(Symbol, FunctionType*,
+                                      util::Span<const Symbol>,
+                                      NodeIndex content_stmt,
+                                      SourceLocation loc) {
+    auto begin = closeBegin();
+    auto node = add(NodeKind::FunctionDefinition, _arrays->function_definitions,
+                    {begin, content_stmt}, loc);
+    _arrays->function_begins[_arrays->nodes[begin].payload].end = node;
+    return node;
+}
+
+void Builder::beginModule(Symbol name, SourceLocation loc) {
+    _open_begins.push_back(
+        add(NodeKind::ModuleBegin, _arrays->module_begins, {name, no_node},
+            loc));
+}
+
+NodeIndex Builder::module(Symbol, util::Span<const NodeIndex> declarations,
+                          SourceLocation loc) {
+    auto begin = closeBegin();
+    auto node = add(NodeKind::Module, _arrays->modules,
+                    {begin, addNodes(declarations)}, loc);
+    _arrays->module_begins[_arrays->nodes[begin].payload].end = node;
+    return node;
+}
+
+Tree Builder::finish(NodeIndex root) {
+    Tree tree;
+#define FLAT_ARRAY(T, name)                                                    \
+    tree._##name = {_arrays->name.data(), _arrays->name.size()};
+#include <elang/flat_arrays.def>
+    tree._arrays = std::exchange(_arrays, std::make_unique<TreeArrays>());
+    tree._type_table = std::move(_type_table);
+    tree._types.assign(tree._nodes.size(), nullptr);
+    tree._root = root;
+    _type_table.clear();
+    _type_indices.clear();
+    _open_begins.clear();
+    return tree;
+}
+
+NodeIndex Builder::closeBegin() {
+    auto begin = _open_begins.back();
+    _open_begins.pop_back();
+    return begin;
+}
+
+TypeIndex Builder::addType(Type* type) {
+    if (!type) {
+        return no_type;
+    }
+    auto found = _type_indices.find(type);
+    if (found != _type_indices.end()) {
+        return found->second;
+    }
+    switch (type->variety) {
+    case Type::Variety::Builtin:
+        break;
+    case Type::Variety::Array:
+        addType(static_cast<ArrayType*>(type)->subtype);
+        break;
+    case Type::Variety::Pointer:
+        addType(static_cast<PointerType*>(type)->subtype);
+        break;
+    case Type::Variety::LValue:
+        addType(static_cast<LValueType*>(type)->subtype);
+        break;
+    case Type::Variety::Function: {
+        auto func_ty = static_cast<FunctionType*>(type);
+        addType(func_ty->return_type);
+        for (auto param_ty : func_ty->params_types) {
+            addType(param_ty);
+        }
+        break;
+    }
+    }
+    auto index = static_cast<TypeIndex>(_type_table.size());
+    _type_table.push_back(type);
+    _type_indices.emplace(type, index);
+    return index;
+}
+
+List Builder::addNodes(util::Span<const NodeIndex> nodes) {
+    List list{static_cast<std::uint32_t>(_arrays->node_lists.size()),
+              static_cast<std::uint32_t>(nodes.size())};
+    _arrays->node_lists.insert(_arrays->node_lists.end(), nodes.begin(),
+                               nodes.end());
+    return list;
+}
+
+List Builder::addSymbols(util::Span<const Symbol> symbols) {
+    List list{static_cast<std::uint32_t>(_arrays->symbol_lists.size()),
+              static_cast<std::uint32_t>(symbols.size())};
+    _arrays->symbol_lists.insert(_arrays->symbol_lists.end(), symbols.begin(),
+                               symbols.end());
+    return list;
+}
+
+} // namespace flat
+} // namespace elang
@@ -0,0 +1,374 @@
+#include <elang/flat_binary.hpp>
+
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <elang/byte_hash.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/string_interner.hpp>
+#include <elang/type.hpp>
+
+namespace elang {
+namespace flat {
+
+namespace {
+
+constexpr char magic[8] = {'e', 'l', 'a', 'n', 'g', 'a', 's', 't'};
+
+// sections start on this boundary, enough for every element type
+constexpr std::uint64_t section_alignment = 8;
+
+enum SectionIndex : unsigned {
+#define FLAT_ARRAY(T, name) name##_section,
+#include <elang/flat_arrays.def>
+    symbol_sizes_section, // std::uint32_t, for the symbols from id 1 on
+    symbol_chars_section, // char
+    type_records_section, // TypeRecord
+    type_lists_section,   // TypeIndex
+    source_path_section,  // char
+    section_count
+};
+
+struct Section {
+    std::uint64_t offset; // from the start of the file
+    std::uint64_t count;  // of elements
+};
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t layout;
+    std::uint32_t root;
+    std::uint32_t source_fileid;
+    std::uint64_t source_size;
+    std::uint64_t source_hash;
+    Section sections[section_count];
+};
+
+// types are recorded after the types they are made of
+struct TypeRecord {
+    std::uint8_t variety;      // Type::Variety
+    std::uint8_t builtin_kind; // BuiltinType::Kind
+    TypeIndex subtype;         // element, pointee or return type
+    std::uint64_t size;        // of arrays
+    List params;               // of functions, in the type lists
+};
+
+constexpr std::uint32_t mix(std::uint32_t hash, std::size_t value) {
+    return (hash ^ static_cast<std::uint32_t>(value)) * 16777619u;
+}
+
+// changes with the size or alignment of anything the file holds as is,
+// and with the byte order
+constexpr std::uint32_t computeLayout() {
+    std::uint32_t hash = 2166136261u;
+#define FLAT_ARRAY(T, name) hash = mix(mix(hash, sizeof(T)), alignof(T));
+#include <elang/flat_arrays.def>
+    hash = mix(hash, sizeof(TypeRecord));
+    hash = mix(hash, sizeof(FileHeader));
+    return hash;
+}
+
+constexpr std::uint32_t layout = computeLayout();
+constexpr std::uint32_t byte_order_probe = 0x01020304;
+
+std::uint32_t layoutOfThisBuild() {
+    unsigned char first_byte;
+    std::memcpy(&first_byte, &byte_order_probe, 1);
+    return mix(layout, first_byte);
+}
+
+std::uint64_t alignSection(std::uint64_t offset) {
+    return (offset + section_alignment - 1) & ~(section_alignment - 1);
+}
+
+class Writer {
+    std::ostream& _out;
+    std::uint64_t _offset{0};
+
+  public:
+    explicit Writer(std::ostream& out) : _out(out) {
+    }
+
+    void write(const void* data, std::size_t bytes) {
+        _out.write(static_cast<const char*>(data),
+                   static_cast<std::streamsize>(bytes));
+        _offset += bytes;
+    }
+
+    void padTo(std::uint64_t offset) {
+        static const char zeros[section_alignment] = {};
+        write(zeros, offset - _offset);
+    }
+};
+
+class FileView {
+    const std::string& _file_path;
+    std::string_view _data;
+    const FileHeader& _header;
+
+  public:
+    FileView(const std::string& file_path, std::string_view data,
+             const FileHeader& header)
+        : _file_path(file_path), _data(data), _header(header) {
+    }
+
+    template <class T>
+    util::Span<const T> get(SectionIndex index) const {
+        auto& section = _header.sections[index];
+        if (section.offset % alignof(T) != 0 || section.offset > _data.size()
+            || section.count > (_data.size() - section.offset) / sizeof(T)) {
+            throw std::runtime_error(_file_path + " is truncated");
+        }
+        // the mapping is page aligned, the offset is aligned for T
+        return {reinterpret_cast<const T*>(_data.data() + section.offset),
+                static_cast<std::size_t>(section.count)};
+    }
+};
+
+} // namespace
+
+void writeBinaryTree(const Tree& tree, SourceManager* sm, std::ostream& out) {
+    auto interner = sm->getInterner();
+    // id 0 is the empty string every interner starts with
+    std::vector<std::uint32_t> symbol_sizes;
+    std::uint64_t symbol_chars = 0;
+    for (std::uint32_t id = 1; id < interner->size(); ++id) {
+        auto size = interner->get(Symbol{id}).size();
+        symbol_sizes.push_back(static_cast<std::uint32_t>(size));
+        symbol_chars += size;
+    }
+
+    std::unordered_map<Type*, TypeIndex> type_indices;
+    for (std::size_t i = 0; i < tree._type_table.size(); ++i) {
+        type_indices.emplace(tree._type_table[i], static_cast<TypeIndex>(i));
+    }
+    std::vector<TypeRecord> type_records;
+    std::vector<TypeIndex> type_lists;
+    for (auto type : tree._type_table) {
+        TypeRecord record{static_cast<std::uint8_t>(type->variety), 0,
+                          no_type, 0, {0, 0}};
+        switch (type->variety) {
+        case Type::Variety::Builtin:
+            record.builtin_kind = static_cast<std::uint8_t>(
+                static_cast<BuiltinType*>(type)->kind);
+            break;
+        case Type::Variety::Array:
+            record.subtype =
+                type_indices.at(static_cast<ArrayType*>(type)->subtype);
+            record.size = static_cast<ArrayType*>(type)->size;
+            break;
+        case Type::Variety::Pointer:
+            record.subtype =
+                type_indices.at(static_cast<PointerType*>(type)->subtype);
+            break;
+        case Type::Variety::LValue:
+            record.subtype =
+                type_indices.at(static_cast<LValueType*>(type)->subtype);
+            break;
+        case Type::Variety::Function: {
+            auto func_ty = static_cast<FunctionType*>(type);
+            record.subtype = type_indices.at(func_ty->return_type);
+            record.params = {static_cast<std::uint32_t>(type_lists.size()),
+                             static_cast<std::uint32_t>(
+                                 func_ty->params_types.size())};
+            for (auto param_ty : func_ty->params_types) {
+                type_lists.push_back(type_indices.at(param_ty));
+            }
+            break;
+        }
+        }
+        type_records.push_back(record);
+    }
+
+    auto fileid = sm->getFileId(tree.location(tree.root()));
+    auto record = sm->getFileRecord(fileid);
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof header);
+    std::memcpy(header.magic, magic, sizeof magic);
+    header.version = binary_tree_version;
+    header.layout = layoutOfThisBuild();
+    header.root = tree.root();
+    header.source_fileid = fileid;
+    header.source_size = record->buffer.size();
+    header.source_hash = util::hashBytes(0, record->buffer);
+
+    std::uint64_t offset = sizeof header;
+    auto place = [&](SectionIndex index, std::size_t count,
+                     std::size_t element_size) {
+        offset = alignSection(offset);
+        header.sections[index] = {offset, count};
+        offset += count * element_size;
+    };
+#define FLAT_ARRAY(T, name)                                                    \
+    place(name##_section, tree._##name.size(), sizeof(T));
+#include <elang/flat_arrays.def>
+    place(symbol_sizes_section, symbol_sizes.size(), sizeof(std::uint32_t));
+    place(symbol_chars_section, symbol_chars, 1);
+    place(type_records_section, type_records.size(), sizeof(TypeRecord));
+    place(type_lists_section, type_lists.size(), sizeof(TypeIndex));
+    place(source_path_section, record->file_path.size(), 1);
+
+    Writer writer{out};
+    writer.write(&header, sizeof header);
+    auto emit = [&](SectionIndex index, const void* data, std::size_t bytes) {
+        writer.padTo(header.sections[index].offset);
+        writer.write(data, bytes);
+    };
+#define FLAT_ARRAY(T, name)                                                    \
+    emit(name##_section, tree._##name.begin(),                                 \
+         tree._##name.size() * sizeof(T));
+#include <elang/flat_arrays.def>
+    emit(symbol_sizes_section, symbol_sizes.data(),
+         symbol_sizes.size() * sizeof(std::uint32_t));
+    writer.padTo(header.sections[symbol_chars_section].offset);
+    for (std::uint32_t id = 1; id < interner->size(); ++id) {
+        auto str = interner->get(Symbol{id});
+        writer.write(str.data(), str.size());
+    }
+    emit(type_records_section, type_records.data(),
+         type_records.size() * sizeof(TypeRecord));
+    emit(type_lists_section, type_lists.data(),
+         type_lists.size() * sizeof(TypeIndex));
+    emit(source_path_section, record->file_path.data(),
+         record->file_path.size());
+
+    if (!out) {
+        throw std::runtime_error("Can't write the binary tree");
+    }
+}
+
+Tree readBinaryTree(const std::string& file_path, SourceManager* sm) {
+    util::MappedFile mapping{file_path};
+    if (!mapping.isMapped()) {
+        throw std::runtime_error("Can't map " + file_path);
+    }
+    auto data = mapping.view();
+
+    FileHeader header;
+    if (data.size() < sizeof header) {
+        throw std::runtime_error(file_path + " is not a binary tree file");
+    }
+    std::memcpy(&header, data.data(), sizeof header);
+    if (std::memcmp(header.magic, magic, sizeof magic) != 0) {
+        throw std::runtime_error(file_path + " is not a binary tree file");
+    }
+    if (header.version != binary_tree_version
+        || header.layout != layoutOfThisBuild()) {
+        throw std::runtime_error(file_path
+                                 + " was written by another elang build");
+    }
+    FileView view{file_path, data, header};
+
+    Tree tree;
+#define FLAT_ARRAY(T, name) tree._##name = view.get<T>(name##_section);
+#include <elang/flat_arrays.def>
+    if (tree._locations.size() != tree._nodes.size()
+        || header.root >= tree._nodes.size()) {
+        throw std::runtime_error(file_path + " is corrupted");
+    }
+
+    // symbols of the tree are ids in the interner, they have to come back
+    // in the same order to keep them
+    auto interner = sm->getInterner();
+    if (interner->size() != 1) {
+        throw std::runtime_error("Binary trees need a fresh interner");
+    }
+    auto symbol_sizes = view.get<std::uint32_t>(symbol_sizes_section);
+    auto symbol_chars = view.get<char>(symbol_chars_section);
+    std::size_t chars_offset = 0;
+    for (std::size_t i = 0; i < symbol_sizes.size(); ++i) {
+        if (symbol_sizes[i] > symbol_chars.size() - chars_offset) {
+            throw std::runtime_error(file_path + " is corrupted");
+        }
+        auto sym = interner->intern(
+            {symbol_chars.begin() + chars_offset, symbol_sizes[i]});
+        if (sym.id != i + 1) {
+            throw std::runtime_error(file_path + " is corrupted");
+        }
+        chars_offset += symbol_sizes[i];
+    }
+
+    auto type_manager = sm->getTypeManager();
+    auto type_records = view.get<TypeRecord>(type_records_section);
+    auto type_lists = view.get<TypeIndex>(type_lists_section);
+    auto loaded = [&](TypeIndex index) {
+        if (index >= tree._type_table.size()) {
+            throw std::runtime_error(file_path + " is corrupted");
+        }
+        return tree._type_table[index];
+    };
+    for (auto& record : type_records) {
+        Type* type = nullptr;
+        switch (static_cast<Type::Variety>(record.variety)) {
+        case Type::Variety::Builtin:
+            switch (record.builtin_kind) {
+            case BuiltinType::Void_ty:
+                type = type_manager->getVoidType();
+                break;
+            case BuiltinType::Int_ty:
+                type = type_manager->getIntType();
+                break;
+            case BuiltinType::Double_ty:
+                type = type_manager->getDoubleType();
+                break;
+            case BuiltinType::Char_ty:
+                type = type_manager->getCharType();
+                break;
+            case BuiltinType::Bool_ty:
+                type = type_manager->getBoolType();
+                break;
+            }
+            break;
+        case Type::Variety::Array:
+            type = type_manager->getArrayType(loaded(record.subtype),
+                                              record.size);
+            break;
+        case Type::Variety::Pointer:
+            type = type_manager->getPointerType(loaded(record.subtype));
+            break;
+        case Type::Variety::LValue:
+            type = type_manager->getLValueType(loaded(record.subtype));
+            break;
+        case Type::Variety::Function: {
+            if (record.params.begin > type_lists.size()
+                || record.params.size
+                       > type_lists.size() - record.params.begin) {
+                throw std::runtime_error(file_path + " is corrupted");
+            }
+            std::vector<Type*> params_ty;
+            for (std::uint32_t i = 0; i < record.params.size; ++i) {
+                params_ty.push_back(
+                    loaded(type_lists[record.params.begin + i]));
+            }
+            type = type_manager->getFunctionType(
+                loaded(record.subtype), {params_ty.data(), params_ty.size()});
+            break;
+        }
+        }
+        if (!type) {
+            throw std::runtime_error(file_path + " is corrupted");
+        }
+        tree._type_table.push_back(type);
+    }
+
+    // locations point into the source, which must be the one parsed
+    auto source_path = view.get<char>(source_path_section);
+    auto fileid = sm->registerFile({source_path.begin(), source_path.size()});
+    auto source = sm->getFileRecord(fileid)->buffer;
+    if (fileid != header.source_fileid || source.size() != header.source_size
+        || util::hashBytes(0, source) != header.source_hash) {
+        throw std::runtime_error("The source of " + file_path
+                                 + " changed since it was written");
+    }
+
+    tree._types.assign(tree._nodes.size(), nullptr);
+    tree._root = header.root;
+    tree._mapping = std::move(mapping);
+    return tree;
+}
+
+} // namespace flat
+} // namespace elang
@@ -0,0 +1,392 @@
+#include <elang/flat_sema.hpp>
+
+#include <algorithm>
+#include <memory>
+
+#include <elang/diagnostic.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/type.hpp>
+
+namespace elang {
+namespace flat {
+
+Sema::Sema(SourceManager* sm)
+    : _type_manager(sm->getTypeManager()),
+      _diag_engine(sm->getDiagnosticEngine()), _interner(sm->getInterner()),
+      _op_inferer(_type_manager), _globals(&_global_table),
+      _current_module(0), _current_return_ty(nullptr), _tree(nullptr) {
+}
+
+Sema::Sema(const Sema& parent, Tree* tree)
+    : _type_manager(parent._type_manager),
+      _diag_engine(parent._diag_engine), _interner(parent._interner),
+      _op_inferer(_type_manager), _globals(parent._globals),
+      _current_module(0), _current_return_ty(nullptr), _tree(tree) {
+}
+
+void Sema::check(Tree* tree, unsigned jobs) {
+    _tree = tree;
+    {
+        DiagnosticEngine::Capture capture{_bodies.declarationSink()};
+        for (NodeIndex node = 0; node < tree->size(); ++node) {
+            switch (tree->kind(node)) {
+            case NodeKind::FunctionDeclaration:
+                checkFunctionDeclaration(node);
+                break;
+            case NodeKind::FunctionBegin:
+                checkFunctionBegin(node);
+                node = tree->functionBegin(node).end;
+                break;
+            case NodeKind::ModuleBegin: {
+                auto& module = tree->moduleBegin(node);
+                if (!_global_table.beginModule(module.name)) {
+                    _diag_engine->report(tree->location(node), 3020,
+                                         _interner->get(module.name));
+                    node = module.end;
+                }
+                break;
+            }
+            case NodeKind::Module:
+                _global_table.endModule();
+                break;
+            default:
+                // only declarations are found outside of bodies
+                break;
+            }
+        }
+    }
+
+    auto threads = _bodies.threads(jobs);
+    std::vector<std::unique_ptr<Sema>> workers;
+    for (unsigned thread = 1; thread < threads; ++thread) {
+        workers.emplace_back(new Sema(*this, tree));
+    }
+    _bodies.check(threads, [&](unsigned thread, std::size_t body) {
+        auto sema = thread == 0 ? this : workers[thread - 1].get();
+        sema->checkBody(_pending[body]);
+    });
+
+    _bodies.report(_diag_engine);
+}
+
+void Sema::checkBody(const PendingBody& body) {
+    auto& begin = _tree->functionBegin(body.begin);
+    auto func_ty = static_cast<FunctionType*>(_tree->typeAt(begin.type));
+    _current_module = body.module;
+    // duplicated parameters were reported with the declarations
+    _local_table.reset();
+    auto param_names = _tree->symbols(begin.param_names);
+    for (std::size_t i = 0; i < param_names.size(); ++i) {
+        _local_table.put(param_names[i], func_ty->params_types[i]);
+    }
+    _current_return_ty = func_ty->return_type;
+    for (auto node = body.begin + 1; node < begin.end; ++node) {
+        checkNode(node);
+    }
+}
+
+void Sema::checkNode(NodeIndex node) {
+    auto tree = _tree;
+    switch (tree->kind(node)) {
+    case NodeKind::BinaryOperator:
+        checkBinaryOperator(node);
+        break;
+    case NodeKind::UnaryOperator:
+        checkUnaryOperator(node);
+        break;
+    case NodeKind::SubscriptExpression:
+        checkSubscriptExpression(node);
+        break;
+    case NodeKind::CallExpression:
+        checkCallExpression(node);
+        break;
+    case NodeKind::CastExpression:
+        checkCastExpression(node);
+        break;
+    case NodeKind::IdentifierReference:
+        checkIdentifierReference(node);
+        break;
+    case NodeKind::IntLiteral:
+        tree->setType(node, _type_manager->getIntType());
+        break;
+    case NodeKind::DoubleLiteral:
+        tree->setType(node, _type_manager->getDoubleType());
+        break;
+    case NodeKind::CharLiteral:
+        tree->setType(node, _type_manager->getCharType());
+        break;
+    case NodeKind::StringLiteral:
+        tree->setType(node, _type_manager->getPointerType(
+                                _type_manager->getCharType()));
+        break;
+    case NodeKind::BoolLiteral:
+        tree->setType(node, _type_manager->getBoolType());
+        break;
+    case NodeKind::SelectionCondition:
+    case NodeKind::IterationCondition: {
+        auto ty = rvalueType(tree->condition(node).expr);
+        tree->setType(node, ty);
+        if (ty != _type_manager->getBoolType()) {
+            _diag_engine->report(
+                tree->location(node),
+                tree->kind(node) == NodeKind::SelectionCondition ? 3021
+                                                                 : 3022);
+        }
+        break;
+    }
+    case NodeKind::BlockBegin:
+        _local_table.beginScope();
+        break;
+    case NodeKind::CompoundStatement:
+        _local_table.endScope();
+        break;
+    case NodeKind::LetStatement:
+        checkLetStatement(node);
+        break;
+    case NodeKind::ReturnStatement:
+        checkReturnStatement(node);
+        break;
+    case NodeKind::ExpressionStatement:
+    case NodeKind::SelectionStatement:
+    case NodeKind::IterationStatement:
+        break;
+    case NodeKind::FunctionDeclaration:
+    case NodeKind::FunctionBegin:
+    case NodeKind::FunctionDefinition:
+    case NodeKind::ModuleBegin:
+    case NodeKind::Module:
+        // not found in bodies
+        break;
+    }
+}
+
+Type* Sema::rvalueType(NodeIndex node) {
+    auto ty = _tree->type(node);
+    if (ty->is(Type::LValue)) {
+        return static_cast<LValueType*>(ty)->subtype;
+    }
+    return ty;
+}
+
+void Sema::checkBinaryOperator(NodeIndex node) {
+    using Kind = ast::BinaryOperator::Kind;
+    auto& op = _tree->binaryOperator(node);
+    auto loc = _tree->location(node);
+
+    if (op.kind == Kind::Assign) {
+        auto lhs_ty = _tree->type(op.lhs);
+        if (!lhs_ty->is(Type::LValue)) {
+            _diag_engine->report(loc, 3001);
+            _tree->setType(node, lhs_ty);
+            return;
+        }
+        lhs_ty = static_cast<LValueType*>(lhs_ty)->subtype;
+        auto rhs_ty = rvalueType(op.rhs);
+        if (lhs_ty != rhs_ty) {
+            _diag_engine->report(loc, 3002, lhs_ty->toString(),
+                                 rhs_ty->toString());
+        }
+        _tree->setType(node, lhs_ty);
+        return;
+    }
+
+    auto lhs_ty = rvalueType(op.lhs);
+    auto rhs_ty = rvalueType(op.rhs);
+    auto inferred = _op_inferer.inferBinary(op.kind, lhs_ty, rhs_ty);
+    if (inferred.failed) {
+        _diag_engine->report(loc, inferred.error, lhs_ty->toString(),
+                             rhs_ty->toString());
+    }
+    _tree->setType(node, inferred.type);
+}
+
+void Sema::checkUnaryOperator(NodeIndex node) {
+    using Kind = ast::UnaryOperator::Kind;
+    auto& op = _tree->unaryOperator(node);
+    auto loc = _tree->location(node);
+
+    if (op.kind == Kind::AddressOf) {
+        auto expr_ty = _tree->type(op.expr);
+        if (!expr_ty->is(Type::LValue)) {
+            _diag_engine->report(loc, 3009);
+            _tree->setType(node, expr_ty);
+            return;
+        }
+        _tree->setType(node,
+                       _type_manager->getPointerType(
+                           static_cast<LValueType*>(expr_ty)->subtype));
+        return;
+    }
+
+    auto expr_ty = rvalueType(op.expr);
+    auto inferred = _op_inferer.inferUnary(op.kind, expr_ty);
+    if (inferred.failed) {
+        _diag_engine->report(loc, inferred.error);
+    }
+    _tree->setType(node, inferred.type);
+}
+
+void Sema::checkSubscriptExpression(NodeIndex node) {
+    auto& subscript = _tree->subscriptExpression(node);
+    auto subscripted_ty = rvalueType(subscript.subscripted);
+
+    if (rvalueType(subscript.index) != _type_manager->getIntType()) {
+        _diag_engine->report(_tree->location(subscript.index), 3010);
+    }
+
+    if (subscripted_ty->variety == Type::Variety::Pointer) {
+        _tree->setType(node,
+                       _type_manager->getLValueType(
+                           static_cast<PointerType*>(subscripted_ty)->subtype));
+    } else if (subscripted_ty->variety == Type::Variety::Array) {
+        _tree->setType(node,
+                       _type_manager->getLValueType(
+                           static_cast<ArrayType*>(subscripted_ty)->subtype));
+    } else {
+        _diag_engine->report(_tree->location(subscript.subscripted), 3011,
+                             subscripted_ty->toString());
+        _tree->setType(node, subscripted_ty);
+    }
+}
+
+void Sema::checkCallExpression(NodeIndex node) {
+    auto& call = _tree->callExpression(node);
+    auto func_ty = _tree->type(call.func);
+    if (!func_ty->is(Type::Function)) {
+        _diag_engine->report(_tree->location(node), 3012,
+                             func_ty->toString());
+        _tree->setType(node, _type_manager->getIntType());
+        return;
+    }
+
+    _args_ty.clear();
+    for (auto arg : _tree->nodes(call.args)) {
+        _args_ty.push_back(rvalueType(arg));
+    }
+    auto& params_ty = static_cast<FunctionType*>(func_ty)->params_types;
+    if (!std::equal(_args_ty.begin(), _args_ty.end(), params_ty.begin(),
+                    params_ty.end())) {
+        _diag_engine->report(_tree->location(node), 3013);
+        _tree->setType(node, _type_manager->getIntType());
+        return;
+    }
+    _tree->setType(node, static_cast<FunctionType*>(func_ty)->return_type);
+}
+
+void Sema::checkCastExpression(NodeIndex node) {
+    auto& cast = _tree->castExpression(node);
+    auto ty = rvalueType(cast.casted);
+    auto to_ty = _tree->typeAt(cast.to_type);
+    if (!_op_inferer.canCast(ty, to_ty)) {
+        _diag_engine->report(_tree->location(node), 3024, ty->toString(),
+                             to_ty->toString());
+    }
+    _tree->setType(node, to_ty);
+}
+
+void Sema::checkIdentifierReference(NodeIndex node) {
+    auto& id = _tree->identifierReference(node);
+    auto module_path = _tree->symbols(id.module_path);
+    Type* ty = nullptr;
+    if (module_path.empty()) {
+        ty = _local_table.get(id.name);
+    }
+
+    if (!ty) {
+        util::Span<const Symbol> resolved_path;
+        ty = _globals->get(_current_module, module_path, id.name,
+                           resolved_path);
+    }
+
+    if (!ty) {
+        _diag_engine->report(_tree->location(node), 3014,
+                             _interner->get(id.name));
+        _tree->setType(node, _type_manager->getIntType());
+        return;
+    }
+
+    if (ty->is(Type::Function)) {
+        _tree->setType(node, ty);
+    } else {
+        _tree->setType(node, _type_manager->getLValueType(ty));
+    }
+}
+
+void Sema::checkLetStatement(NodeIndex node) {
+    auto& let = _tree->letStatement(node);
+    auto ty = _tree->typeAt(let.type);
+
+    if (let.init_expr != no_node) {
+        auto init_ty = rvalueType(let.init_expr);
+        if (!ty) {
+            ty = init_ty;
+        } else if (init_ty != ty) {
+            _diag_engine->report(_tree->location(node), 3015,
+                                 _interner->get(let.name), init_ty->toString(),
+                                 ty->toString());
+            return;
+        }
+    }
+    _tree->setType(node, ty);
+
+    if (!_local_table.put(let.name, ty)) {
+        _diag_engine->report(_tree->location(node), 3016,
+                             _interner->get(let.name));
+    }
+}
+
+void Sema::checkReturnStatement(NodeIndex node) {
+    auto expr = _tree->returnStatement(node).expr;
+    auto ty = expr != no_node ? rvalueType(expr) : _type_manager->getVoidType();
+    if (ty != _current_return_ty) {
+        _diag_engine->report(_tree->location(node), 3023, ty->toString(),
+                             _current_return_ty->toString());
+    }
+}
+
+void Sema::checkFunctionDeclaration(NodeIndex node) {
+    auto& decl = _tree->functionDeclaration(node);
+    auto decl_ty = static_cast<FunctionType*>(_tree->typeAt(decl.type));
+    auto current_state = _global_table.getStateInModule(decl.name);
+    if (current_state.second == GlobalTable::State::Defined) {
+        _diag_engine->report(_tree->location(node), 3018,
+                             _interner->get(decl.name));
+    } else if (current_state.second == GlobalTable::State::Declared
+               && current_state.first != decl_ty) {
+        _diag_engine->report(_tree->location(node), 3019,
+                             _interner->get(decl.name));
+    } else {
+        _global_table.declare(decl.name, decl_ty);
+    }
+}
+
+void Sema::checkFunctionBegin(NodeIndex node) {
+    auto& begin = _tree->functionBegin(node);
+    auto func_ty = static_cast<FunctionType*>(_tree->typeAt(begin.type));
+    auto current_state = _global_table.getStateInModule(begin.name);
+    if (current_state.second == GlobalTable::State::Defined) {
+        _diag_engine->report(_tree->location(node), 3018,
+                             _interner->get(begin.name));
+        return;
+    } else if (current_state.second == GlobalTable::State::Declared
+               && current_state.first != func_ty) {
+        _diag_engine->report(_tree->location(node), 3019,
+                             _interner->get(begin.name));
+        return;
+    }
+
+    _global_table.define(begin.name, func_ty);
+    _local_table.reset();
+    auto param_names = _tree->symbols(begin.param_names);
+    for (std::size_t i = 0; i < param_names.size(); ++i) {
+        if (!_local_table.put(param_names[i], func_ty->params_types[i])) {
+            _diag_engine->report(_tree->location(node), 3017,
+                                 _interner->get(param_names[i]));
+        }
+    }
+    _pending.push_back({node, _global_table.currentModule()});
+    _bodies.addBody();
+}
+
+} // namespace flat
+} // namespace elang
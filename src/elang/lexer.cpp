@@ -6,169 +6,292 @@
 #include <elang/source_manager.hpp>
 #include <elang/diagnostic.hpp>
 #include <elang/source_location.hpp>
+#include <elang/char_scan.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
 
 // utils
-bool isSpace(int c) {
-    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+bool isDigit(int c) {
+    return '0' <= c && c <= '9';
 }
 
-bool isAlpha(int c) {
-    return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_';
+namespace elang {
+
+namespace {
+
+// Lexer tables, built at compile time from tokenkind.def.
+//
+// Every char has a class telling how a token starting with it is read.
+// Punctuators are recognized by a small DFA: the first char leads to a
+// state accepting a one-char punctuator, from which a second char may lead
+// to a two-char one.
+
+enum class CharClass : std::uint8_t {
+    Invalid,
+    Space,
+    Alpha,
+    Digit,
+    Punctuator,
+    DoubleQuote,
+    SingleQuote,
+    Hash
+};
+
+struct PunctuatorSpelling {
+    Token::Kind kind;
+    const char* spelling;
+};
+
+constexpr PunctuatorSpelling punctuators[] = {
+#define PUNCTUATOR(X, Y) {Token::Kind::X, Y},
+#include <elang/tokenkind.def>
+};
+
+constexpr std::size_t punctuator_count
+    = sizeof(punctuators) / sizeof(punctuators[0]);
+
+constexpr std::size_t spellingLength(const char* spelling) {
+    std::size_t length = 0;
+    while (spelling[length]) {
+        ++length;
+    }
+    return length;
 }
 
-bool isDigit(int c) {
-    return '0' <= c && c <= '9';
+struct LexerTables {
+    // state 0 is the start state, the others follow one punctuator char
+    static constexpr std::size_t max_states = punctuator_count + 1;
+    static constexpr std::uint8_t no_state = 0;
+
+    std::array<CharClass, 256> char_class{};
+    std::array<std::uint8_t, 256> first_state{};
+    std::array<Token::Kind, max_states> accepted_kind{};
+    std::array<std::array<Token::Kind, 256>, max_states> second_kind{};
+    std::array<std::array<bool, 256>, max_states> has_second{};
+};
+
+constexpr LexerTables buildLexerTables() {
+    LexerTables tables{};
+
+    for (unsigned c = 0; c < 256; ++c) {
+        tables.char_class[c] = CharClass::Invalid;
+    }
+    for (unsigned c : {' ', '\n', '\t', '\r'}) {
+        tables.char_class[c] = CharClass::Space;
+    }
+    for (unsigned c = 'a'; c <= 'z'; ++c) {
+        tables.char_class[c] = CharClass::Alpha;
+        tables.char_class[c - 'a' + 'A'] = CharClass::Alpha;
+    }
+    tables.char_class['_'] = CharClass::Alpha;
+    for (unsigned c = '0'; c <= '9'; ++c) {
+        tables.char_class[c] = CharClass::Digit;
+    }
+    tables.char_class['\"'] = CharClass::DoubleQuote;
+    tables.char_class['\''] = CharClass::SingleQuote;
+    tables.char_class['#'] = CharClass::Hash;
+
+    std::uint8_t state_count = 1;
+    for (std::size_t length = 1; length <= 2; ++length) {
+        for (auto& punctuator : punctuators) {
+            if (spellingLength(punctuator.spelling) != length) {
+                continue;
+            }
+            auto first = static_cast<unsigned char>(punctuator.spelling[0]);
+            if (length == 1) {
+                tables.char_class[first] = CharClass::Punctuator;
+                tables.first_state[first] = state_count;
+                tables.accepted_kind[state_count] = punctuator.kind;
+                ++state_count;
+            } else {
+                // the one-char prefix must be a punctuator too
+                auto state = tables.first_state[first];
+                auto second
+                    = static_cast<unsigned char>(punctuator.spelling[1]);
+                tables.second_kind[state][second] = punctuator.kind;
+                tables.has_second[state][second] = true;
+            }
+        }
+    }
+    return tables;
 }
 
-namespace elang {
+constexpr bool checkPunctuators() {
+    for (auto& punctuator : punctuators) {
+        auto length = spellingLength(punctuator.spelling);
+        if (length == 0 || length > 2) {
+            return false;
+        }
+        if (length == 2) {
+            bool has_prefix = false;
+            for (auto& prefix : punctuators) {
+                if (spellingLength(prefix.spelling) == 1
+                    && prefix.spelling[0] == punctuator.spelling[0]) {
+                    has_prefix = true;
+                }
+            }
+            if (!has_prefix) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(checkPunctuators(),
+              "punctuators must be one or two chars long, and the first "
+              "char of a two-char punctuator must be a punctuator too");
+
+constexpr LexerTables lexer_tables = buildLexerTables();
+
+inline unsigned char toIndex(int c) {
+    return static_cast<unsigned char>(c);
+}
+
+} // namespace
 
 Lexer::Lexer(SourceManager* source_manager, unsigned fileid)
     : _source_manager(source_manager),
       _diag_engine(_source_manager->getDiagnosticEngine()),
+      _interner(_source_manager->getInterner()),
       _reader(_source_manager->getBuffer(fileid)) {
 }
 
-Token Lexer::peekToken() {
-    _waiting_tokens.push(getToken());
-    return _waiting_tokens.top();
+Lexer::Lexer(SourceManager* source_manager, unsigned fileid,
+             std::size_t offset, Symbols symbols)
+    : Lexer(source_manager, fileid) {
+    if (symbols == Symbols::Defer) {
+        _interner = nullptr;
+    }
+    _reader.advance(offset);
 }
 
 Token Lexer::getToken() {
-    if (!_waiting_tokens.empty()) {
-        auto tok = _waiting_tokens.top();
-        _waiting_tokens.pop();
-        return tok;
+    // skipped chars (comments, invalid chars) loop back here
+    while (true) {
+        eatWhiteSpaces();
+        auto token_location = _reader.getCurrentLocation();
+        auto current = _reader.get();
+        if (current == std::char_traits<char>::eof()) {
+            return Token{Token::Kind::eof, token_location};
+        }
+
+        switch (lexer_tables.char_class[toIndex(current)]) {
+        case CharClass::Punctuator:
+            return makePunctuatorToken(current, token_location);
+        case CharClass::Alpha:
+            _reader.unget();
+            return makeIdentiferOrKeywordToken();
+        case CharClass::Digit:
+            _reader.unget();
+            return makeIntegerOrDoubleLiteralToken();
+        case CharClass::DoubleQuote:
+            return makeStringLiteralToken(token_location);
+        case CharClass::SingleQuote:
+            return makeCharLiteralToken(token_location);
+        case CharClass::Space:
+        case CharClass::Hash:
+            // already eaten by eatWhiteSpaces
+            _reader.unget();
+            break;
+        case CharClass::Invalid:
+            _diag_engine->report(token_location, 1001,
+                                 std::string{1, static_cast<char>(current)});
+            break;
+        }
     }
+}
+
+Token Lexer::makePunctuatorToken(int first, SourceLocation loc) {
+    auto state = lexer_tables.first_state[toIndex(first)];
+    auto next = _reader.peek();
+    if (next != std::char_traits<char>::eof()
+        && lexer_tables.has_second[state][toIndex(next)]) {
+        _reader.get();
+        return Token{lexer_tables.second_kind[state][toIndex(next)], loc, 2};
+    }
+    return Token{lexer_tables.accepted_kind[state], loc, 1};
+}
 
-    eatWhiteSpaces();
-    auto token_location = _reader.getCurrentLocation();
-    auto current = _reader.get();
-    if (current == std::char_traits<char>::eof()) {
-        return Token{Token::Kind::eof, token_location};
-    } else if (current == '[') {
-        return Token{Token::Kind::l_square, token_location};
-    } else if (current == ']') {
-        return Token{Token::Kind::r_square, token_location};
-    } else if (current == '(') {
-        return Token{Token::Kind::l_paren, token_location};
-    } else if (current == ')') {
-        return Token{Token::Kind::r_paren, token_location};
-    } else if (current == '{') {
-        return Token{Token::Kind::l_brace, token_location};
-    } else if (current == '}') {
-        return Token{Token::Kind::r_brace, token_location};
-    } else if (current == '*') {
-        return Token{Token::Kind::star, token_location};
-    } else if (current == '+') {
-        return Token{Token::Kind::plus, token_location};
-    } else if (current == '%') {
-        return Token{Token::Kind::percent, token_location};
-    } else if (current == ';') {
-        return Token{Token::Kind::semi, token_location};
-    } else if (current == ',') {
-        return Token{Token::Kind::comma, token_location};
-    } else if (current == '.') {
-        return Token{Token::Kind::dot, token_location};
-    } else if (current == '/') {
-        return Token{Token::Kind::slash, token_location};
-    } else if (current == '-') {
-        return Token{
-            twoCharTokenKind('>', Token::Kind::minus, Token::Kind::arrow),
-            token_location};
-    } else if (current == '<') {
-        return Token{
-            twoCharTokenKind('=', Token::Kind::less, Token::Kind::lessequal),
-            token_location};
-    } else if (current == '>') {
-        return Token{twoCharTokenKind('=', Token::Kind::greater,
-                                      Token::Kind::greaterequal),
-                     token_location};
-    } else if (current == ':') {
-        return Token{
-            twoCharTokenKind(':', Token::Kind::colon, Token::Kind::coloncolon),
-            token_location};
-    } else if (current == '=') {
-        return Token{
-            twoCharTokenKind('=', Token::Kind::equal, Token::Kind::equalequal),
-            token_location};
-    } else if (current == '!') {
-        return Token{twoCharTokenKind('=', Token::Kind::exclaim,
-                                      Token::Kind::exclaimequal),
-                     token_location};
-    } else if (current == '&') {
-        return Token{
-            twoCharTokenKind('&', Token::Kind::amp, Token::Kind::ampamp),
-            token_location};
-    } else if (current == '|') {
-        return Token{
-            twoCharTokenKind('|', Token::Kind::pipe, Token::Kind::pipepipe),
-            token_location};
-    } else if (current == '\"') {
-        std::string literal_string;
-        while (_reader.peek() != '\"') {
-            if (_reader.peek() == std::char_traits<char>::eof()) {
-                _diag_engine->report(token_location, 1002);
+Token Lexer::makeStringLiteralToken(SourceLocation loc) {
+    // the value is only copied once an escape sequence shows up
+    auto content_begin = _reader.position();
+    bool plain = true;
+    std::string decoded;
+    while (_reader.peek() != '\"') {
+        if (_reader.peek() == std::char_traits<char>::eof()) {
+            _diag_engine->report(loc, 1002);
+            // no closing quote to strip from the spelling
+            if (plain) {
+                plain = false;
+                decoded.assign(content_begin, _reader.position());
             }
-            literal_string.push_back(readLiteralChar());
+            break;
         }
-        _reader.get();
-        return Token{Token::Kind::string_literal, token_location,
-                     literal_string};
-    } else if (current == '\'') {
-        std::string literal_char;
-        literal_char.push_back(readLiteralChar());
-        if (_reader.get() != '\'') {
-            _diag_engine->report(token_location, 1003);
+        if (plain && _reader.peek() == '\\') {
+            plain = false;
+            decoded.assign(content_begin, _reader.position());
+        }
+        auto c = readLiteralChar();
+        if (!plain) {
+            decoded.push_back(c);
         }
-        return Token{Token::Kind::char_literal, token_location, literal_char};
-    } else if (current == '#') {
-        readComment();
-        return getToken();
-    } else if (isAlpha(current)) {
-        _reader.unget();
-        return makeIdentiferOrKeywordToken();
-    } else if (isDigit(current)) {
-        _reader.unget();
-        return makeIntegerOrDoubleLiteralToken();
-    } else {
-        _diag_engine->report(token_location, 1001,
-                             std::string{1, static_cast<char>(current)});
-        return getToken();
     }
+    _reader.get();
+
+    auto tok = makeToken(Token::Kind::string_literal, loc);
+    if (!plain) {
+        tok.flags |= Token::Flags::Decoded;
+        tok.data = addDecodedLiteral(decoded);
+    }
+    return tok;
 }
 
-bool Lexer::matchChar(int expected) {
-    if (_reader.peek() != expected)
-        return false;
-    _reader.get();
-    return true;
+Token Lexer::makeCharLiteralToken(SourceLocation loc) {
+    bool plain = _reader.peek() != '\\';
+    auto c = readLiteralChar();
+    if (_reader.get() != '\'') {
+        _diag_engine->report(loc, 1003);
+    }
+
+    auto tok = makeToken(Token::Kind::char_literal, loc);
+    if (!plain || tok.length != 3) {
+        tok.flags |= Token::Flags::Decoded;
+        tok.data = addDecodedLiteral(std::string_view{&c, 1});
+    }
+    return tok;
 }
 
-Token::Kind Lexer::twoCharTokenKind(int expected, Token::Kind tk1,
-                                    Token::Kind tk2) {
-    return matchChar(expected) ? tk2 : tk1;
+Token Lexer::makeToken(Token::Kind kind, SourceLocation loc) {
+    return Token{kind, loc,
+                 static_cast<std::uint32_t>(
+                     _reader.getCurrentLocation().raw - loc.raw)};
 }
 
+// also eats comments, they are only separators for the lexer
 void Lexer::eatWhiteSpaces() {
-    while (isSpace(_reader.peek())) {
-        _reader.get();
+    _reader.advance(
+        util::skipWhiteSpaces(_reader.position(), _reader.remaining()));
+    while (_reader.peek() == '#') {
+        readComment();
+        _reader.advance(
+            util::skipWhiteSpaces(_reader.position(), _reader.remaining()));
     }
 }
 
-std::string Lexer::readIdentifierOrKeyword() {
-    std::string buffer;
-    while (isAlpha(_reader.peek()) || isDigit(_reader.peek())) {
-        buffer.push_back(_reader.get());
-    }
-    return buffer;
+std::string_view Lexer::readIdentifierOrKeyword() {
+    auto begin = _reader.position();
+    auto size = util::skipIdentifierChars(begin, _reader.remaining());
+    _reader.advance(size);
+    return std::string_view{begin, size};
 }
 
-std::string Lexer::readNumber() {
-    std::string buffer;
+void Lexer::readNumber() {
     while (isDigit(_reader.peek())) {
-        buffer.push_back(_reader.get());
+        _reader.get();
     }
-    return buffer;
 }
 
 char Lexer::readLiteralChar() {
@@ -218,42 +341,51 @@ char Lexer::readLiteralChar() {
 }
 
 void Lexer::readComment() {
-    while (_reader.peek() != '\n'
-           && _reader.peek() != std::char_traits<char>::eof()) {
-        _reader.get();
+    _reader.advance(
+        util::skipToNewline(_reader.position(), _reader.remaining()));
+}
+
+std::uint32_t Lexer::addDecodedLiteral(std::string_view literal) {
+    if (_interner) {
+        return _interner->intern(literal).id;
     }
+    _decoded_literals.emplace_back(literal);
+    return _decoded_literals.size() - 1;
 }
 
 Token Lexer::makeIdentiferOrKeywordToken() {
     auto loc = _reader.getCurrentLocation();
     auto identifier_or_keyword = readIdentifierOrKeyword();
-    return Token::fromIdentifier(loc, identifier_or_keyword);
+    auto tok = Token::fromIdentifier(loc, identifier_or_keyword);
+    if (tok.is(Token::Kind::identifier) && _interner) {
+        tok.data = _interner->intern(identifier_or_keyword).id;
+    }
+    return tok;
 }
 
 Token Lexer::makeIntegerOrDoubleLiteralToken() {
     auto loc = _reader.getCurrentLocation();
     auto is_double = false;
 
-    std::string value;
-    value = readNumber();
+    readNumber();
     if (_reader.peek() == '.') {
         is_double = true;
-        value.push_back(_reader.get());
-        value += readNumber();
+        _reader.get();
+        readNumber();
     }
 
     if (_reader.peek() == 'e' || _reader.peek() == 'E') {
         is_double = true;
-        value.push_back(_reader.get());
+        _reader.get();
         if (_reader.peek() == '+' || _reader.peek() == '-') {
-            value.push_back(_reader.get());
-            value += readNumber();
+            _reader.get();
+            readNumber();
         }
     }
 
-    return Token{is_double ? Token::Kind::double_literal
-                           : Token::Kind::int_literal,
-                 loc, value};
+    return makeToken(is_double ? Token::Kind::double_literal
+                               : Token::Kind::int_literal,
+                     loc);
 }
 
 } // namespace elang
@@ -1,37 +1,148 @@
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
 
+#include <elang/alloc_stats.hpp>
+#include <elang/flat_binary.hpp>
+#include <elang/flat_sema.hpp>
 #include <elang/source_manager.hpp>
 #include <elang/lexer.hpp>
+#include <elang/parallel_lexer.hpp>
+#include <elang/parallel_parser.hpp>
 #include <elang/parser.hpp>
+#include <elang/token_buffer.hpp>
 #include <elang/debug_visitor.hpp>
 #include <elang/sema_visitor.hpp>
 #include <elang/ast.hpp>
 
 int main(int argc, char** argv) {
     std::cout.sync_with_stdio(false);
-    std::string path
-        = (argc <= 1 || std::string{argv[1]} == "-") ? "-" : argv[1];
+    std::string path = "-";
+    // lexer diagnostics are reported ahead of the parser ones when the file
+    // is lexed eagerly
+    auto lex_mode = elang::TokenBuffer::Mode::Streaming;
+    unsigned lex_jobs = 0;
+    // the function bodies are parsed ahead on several threads once the
+    // whole file is lexed, so this lexes eagerly
+    unsigned parse_jobs = 0;
+    // the function bodies are checked on several threads once every
+    // signature is known
+    unsigned sema_jobs = 1;
+    // only prints the declarations, the function bodies are never parsed
+    bool signatures = false;
+    // writes the flat tree of the file instead of compiling it
+    std::string emit_ast_bin;
+    // checks a tree written by --emit-ast-bin instead of parsing a file
+    std::string load_ast_bin;
+    // prints the allocations of the lexer, parser and sema on stderr, the
+    // lexer ones are part of the parser ones unless lexing is eager
+    bool alloc_stats = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg{argv[i]};
+        if (arg == "--eager-lex") {
+            lex_mode = elang::TokenBuffer::Mode::Eager;
+        } else if (arg.compare(0, 11, "--lex-jobs=") == 0) {
+            lex_jobs = std::stoul(arg.substr(11));
+        } else if (arg == "--signatures") {
+            signatures = true;
+        } else if (arg.compare(0, 13, "--parse-jobs=") == 0) {
+            parse_jobs = std::stoul(arg.substr(13));
+            lex_mode = elang::TokenBuffer::Mode::Eager;
+        } else if (arg.compare(0, 12, "--sema-jobs=") == 0) {
+            sema_jobs = std::stoul(arg.substr(12));
+        } else if (arg.compare(0, 15, "--emit-ast-bin=") == 0) {
+            emit_ast_bin = arg.substr(15);
+        } else if (arg.compare(0, 15, "--load-ast-bin=") == 0) {
+            load_ast_bin = arg.substr(15);
+        } else if (arg == "--alloc-stats") {
+            alloc_stats = true;
+        } else {
+            path = arg;
+        }
+    }
 
     elang::SourceManager source_manager;
 
+    if (!load_ast_bin.empty()) {
+        elang::flat::Tree tree;
+        try {
+            tree = elang::flat::readBinaryTree(load_ast_bin, &source_manager);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        elang::flat::Sema sema{&source_manager};
+        sema.check(&tree, sema_jobs);
+        std::cout << "sema done" << std::endl;
+        return 0;
+    }
+
     unsigned index;
     if (path == "-")
         index = source_manager.registerStdin();
     else
         index = source_manager.registerFile(path);
 
+    auto reportAllocations = [alloc_stats](const char* phase,
+                                           elang::util::AllocationStats since) {
+        if (alloc_stats) {
+            auto stats = elang::util::allocationStats() - since;
+            std::cerr << "alloc/" << phase << ": " << stats.count
+                      << " allocations, " << stats.bytes << " bytes"
+                      << std::endl;
+        }
+    };
+
+    auto before = elang::util::allocationStats();
     elang::Lexer lexer{&source_manager, index};
-    elang::Parser parser{&lexer, &source_manager};
+    std::unique_ptr<elang::TokenBuffer> tokens;
+    if (lex_jobs) {
+        tokens = std::make_unique<elang::TokenBuffer>();
+        elang::lexInParallel(&source_manager, index, lex_jobs, tokens.get());
+    } else {
+        tokens = std::make_unique<elang::TokenBuffer>(&lexer, lex_mode);
+    }
+    reportAllocations("lexer", before);
+
+    if (!emit_ast_bin.empty()) {
+        elang::FlatParser parser{tokens.get(), &source_manager};
+        auto root = parser.parseMainModule();
+        auto tree = parser.getBuilder()->finish(root);
+        std::ofstream out{emit_ast_bin, std::ios::binary};
+        try {
+            elang::flat::writeBinaryTree(tree, &source_manager, out);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (signatures) {
+        elang::BodyLoader body_loader{tokens.get(), &source_manager};
+        elang::Parser parser{tokens.get(), &source_manager};
+        parser.setBodyLoader(&body_loader);
+        auto main_mod = parser.parseMainModule();
+        elang::ast::DebugVisitor debug_visitor{&source_manager, false};
+        debug_visitor.dispatch(main_mod);
+        return 0;
+    }
 
-    auto main_mod = parser.parseMainModule();
-    elang::ast::DebugVisitor debug_visitor;
-    main_mod->accept(&debug_visitor);
+    before = elang::util::allocationStats();
+    auto main_mod = elang::parseInParallel(tokens.get(), &source_manager,
+                                           parse_jobs);
+    reportAllocations("parser", before);
+    elang::ast::DebugVisitor debug_visitor{&source_manager};
+    debug_visitor.dispatch(main_mod);
 
+    before = elang::util::allocationStats();
     elang::ast::SemaVisitor sema_visitor{&source_manager};
-    main_mod->accept(&sema_visitor);
+    sema_visitor.check(main_mod, sema_jobs);
+    reportAllocations("sema", before);
 
     std::cout << "sema done" << std::endl;
 
-    main_mod->accept(&debug_visitor);
+    debug_visitor.dispatch(main_mod);
 }
@@ -1,19 +1,24 @@
 #include <elang/op_inferer.hpp>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
 #include <elang/type.hpp>
 
 // Binary Op:
-// IntAdd DoubleAdd ok
-// IntSub DoubleSub ok
+// IntAdd DoubleAdd PtrAdd ok
+// IntSub DoubleSub PtrSub ok
 // IntMul DoubleMul ok
 // IntDiv DoubleDiv ok
-// IntMod ok
+// IntMod DoubleMod ok
 // IntLess DoubleLess ok
 // IntLessEqu DoubleLessEqu ok
 // IntGreater DoubleGreater ok
 // IntGreaterEqu DoubleGreaterEqu ok
-// IntEqu DoubleEqu CharEqu BoolEqu ok
-// IntDiff DoubleDiff CharDiff BoolDiff ok
+// IntEqu DoubleEqu CharEqu BoolEqu (any same type but void) ok
+// IntDiff DoubleDiff CharDiff BoolDiff (any same type but void) ok
 // BoolAnd BoolOr
 //
 // Unary Op:
@@ -21,96 +26,271 @@
 // DoublePlus DoubleMinus
 // BoolNot
 // PtrDeref AddressOf
+//
+// Cast:
+// between any of int, double, char and bool
+// PtrToPtr IntToPtr CharToPtr PtrToInt PtrToChar
+// any type to itself
 
 namespace elang {
 
-OpInferer::OpInferer(TypeManager* tm) : _type_manager(tm) {
+namespace {
+
+// what the tables tell apart: the classes of the property bits, and the
+// builtins that have none
+enum class OperandClass : std::uint8_t {
+    Void,
+    Int,
+    Double,
+    Char,
+    Bool,
+    Pointer,
+    Other
+};
+constexpr std::size_t operand_classes = 7;
+
+constexpr std::size_t index(OperandClass operand_class) {
+    return static_cast<std::size_t>(operand_class);
 }
 
-Type* OpInferer::inferBinaryAddOrMinus(Type* lhs_ty, Type* rhs_ty) {
-    auto int_ty = _type_manager->getIntType();
-    auto double_ty = _type_manager->getDoubleType();
-    if (lhs_ty == int_ty && rhs_ty == int_ty) {
-        return int_ty;
-    } else if (lhs_ty == double_ty && rhs_ty == double_ty) {
-        return double_ty;
-    }
+// the properties of the types of each class, which the tables are built
+// from
+constexpr std::uint8_t class_properties[operand_classes] = {
+    0,                                  // Void
+    Type::Arithmetic | Type::Integral,  // Int
+    Type::Arithmetic,                   // Double
+    Type::Integral,                     // Char
+    0,                                  // Bool
+    Type::Pointer,                      // Pointer
+    0,                                  // Other
+};
 
-    if (lhs_ty->variety == Type::Variety::Pointer && rhs_ty == int_ty) {
-        return lhs_ty;
+constexpr bool classHas(std::size_t operand_class, std::uint8_t properties) {
+    return (class_properties[operand_class] & properties) == properties;
+}
+
+OperandClass classOf(const Type* ty) {
+    if (ty->is(Type::Arithmetic)) {
+        return ty->is(Type::Integral) ? OperandClass::Int
+                                      : OperandClass::Double;
+    }
+    if (ty->is(Type::Integral)) {
+        return OperandClass::Char;
+    }
+    if (ty->is(Type::Pointer)) {
+        return OperandClass::Pointer;
+    }
+    switch (ty->id) {
+    case BuiltinType::Kind::Void_ty:
+        return OperandClass::Void;
+    case BuiltinType::Kind::Bool_ty:
+        return OperandClass::Bool;
+    default:
+        return OperandClass::Other;
     }
-    return nullptr;
 }
 
-Type* OpInferer::inferBinaryTimesOrDivide(Type* lhs_ty, Type* rhs_ty) {
-    auto int_ty = _type_manager->getIntType();
-    auto double_ty = _type_manager->getDoubleType();
-    if (lhs_ty == int_ty && rhs_ty == int_ty) {
-        return int_ty;
-    } else if (lhs_ty == double_ty && rhs_ty == double_ty) {
-        return double_ty;
+// type of the result, in terms of the operands
+enum class Result : std::uint8_t {
+    Error,
+    Bool,
+    Operand,    // the type of the (left) operand
+    BoolIfSame, // bool when both operands have the same type
+    Subtype     // what the operand points to
+};
+
+using BinaryResults
+    = std::array<std::array<Result, operand_classes>, operand_classes>;
+using UnaryResults = std::array<Result, operand_classes>;
+
+// Result for both operands of the same class having properties
+constexpr BinaryResults sameClassResults(std::uint8_t properties,
+                                         Result result) {
+    BinaryResults results{};
+    for (std::size_t i = 0; i < operand_classes; ++i) {
+        if (classHas(i, properties)) {
+            results[i][i] = result;
+        }
     }
-    return nullptr;
+    return results;
 }
 
-Type* OpInferer::inferBinaryModulo(Type* lhs_ty, Type* rhs_ty) {
-    auto int_ty = _type_manager->getIntType();
-    if (lhs_ty == int_ty && rhs_ty == int_ty) {
-        return int_ty;
+constexpr BinaryResults comparisonResults() {
+    return sameClassResults(Type::Arithmetic, Result::Bool);
+}
+
+constexpr BinaryResults equalityResults() {
+    BinaryResults results{};
+    for (auto operand_class : {OperandClass::Int, OperandClass::Double,
+                               OperandClass::Char, OperandClass::Bool}) {
+        results[index(operand_class)][index(operand_class)] = Result::Bool;
     }
-    return nullptr;
+    for (auto operand_class : {OperandClass::Pointer, OperandClass::Other}) {
+        results[index(operand_class)][index(operand_class)]
+            = Result::BoolIfSame;
+    }
+    return results;
 }
 
-Type* OpInferer::inferBinaryEqualOrDifferent(Type* lhs_ty, Type* rhs_ty) {
-    if (lhs_ty != rhs_ty)
-        return nullptr;
+constexpr BinaryResults arithmeticResults(bool pointer_offset) {
+    auto results = sameClassResults(Type::Arithmetic, Result::Operand);
+    if (!pointer_offset) {
+        return results;
+    }
+    // a pointer moves by an integer
+    for (std::size_t i = 0; i < operand_classes; ++i) {
+        if (classHas(i, Type::Arithmetic | Type::Integral)) {
+            results[index(OperandClass::Pointer)][i] = Result::Operand;
+        }
+    }
+    return results;
+}
 
-    if (lhs_ty == _type_manager->getVoidType())
-        return nullptr;
+constexpr BinaryResults logicalResults() {
+    BinaryResults results{};
+    results[index(OperandClass::Bool)][index(OperandClass::Bool)]
+        = Result::Bool;
+    return results;
+}
 
-    return _type_manager->getBoolType();
+constexpr UnaryResults logicalNotResults() {
+    UnaryResults results{};
+    results[index(OperandClass::Bool)] = Result::Operand;
+    return results;
 }
 
-Type* OpInferer::inferBinaryComp(Type* lhs_ty, Type* rhs_ty) {
-    auto int_ty = _type_manager->getIntType();
-    auto double_ty = _type_manager->getDoubleType();
-    if ((lhs_ty == int_ty && rhs_ty == int_ty)
-        || (lhs_ty == double_ty && rhs_ty == double_ty)) {
-        return _type_manager->getBoolType();
+// result for an operand of any class having properties
+constexpr UnaryResults unaryResults(std::uint8_t properties, Result result) {
+    UnaryResults results{};
+    for (std::size_t i = 0; i < operand_classes; ++i) {
+        if (classHas(i, properties)) {
+            results[i] = result;
+        }
     }
-    return nullptr;
+    return results;
 }
 
-Type* OpInferer::inferBinaryAndOrOr(Type* lhs_ty, Type* rhs_ty) {
-    auto bool_ty = _type_manager->getBoolType();
-    if (lhs_ty == bool_ty && rhs_ty == bool_ty) {
-        return bool_ty;
+struct BinaryRule {
+    BinaryResults results;
+    unsigned error;  // reported when the result is Error
+    Result fallback; // the type to go on with then
+};
+
+struct UnaryRule {
+    UnaryResults results;
+    unsigned error;
+    Result fallback;
+};
+
+// indexed by ast::BinaryOperator::Kind
+constexpr BinaryRule binary_rules[] = {
+    {BinaryResults{}, 0, Result::Error},                // Assign, checked apart
+    {comparisonResults(), 3003, Result::Bool},          // LessOrEqual
+    {comparisonResults(), 3003, Result::Bool},          // Less
+    {comparisonResults(), 3003, Result::Bool},          // Greater
+    {comparisonResults(), 3003, Result::Bool},          // GreaterOrEqual
+    {equalityResults(), 3003, Result::Bool},            // Equal
+    {equalityResults(), 3003, Result::Bool},            // Different
+    {arithmeticResults(true), 3004, Result::Operand},   // Add
+    {arithmeticResults(true), 3004, Result::Operand},   // Minus
+    {arithmeticResults(false), 3004, Result::Operand},  // Times
+    {arithmeticResults(false), 3004, Result::Operand},  // Divide
+    {arithmeticResults(false), 3004, Result::Operand},  // Modulo
+    {logicalResults(), 3005, Result::Bool},             // LogicalAnd
+    {logicalResults(), 3005, Result::Bool},             // LogicalOr
+};
+static_assert(sizeof(binary_rules) / sizeof(binary_rules[0])
+                  == static_cast<std::size_t>(
+                         ast::BinaryOperator::Kind::LogicalOr)
+                         + 1,
+              "one rule per binary operator");
+
+// indexed by ast::UnaryOperator::Kind
+constexpr UnaryRule unary_rules[] = {
+    {unaryResults(Type::Arithmetic, Result::Operand), 3006,
+     Result::Operand}, // Plus
+    {unaryResults(Type::Arithmetic, Result::Operand), 3006,
+     Result::Operand}, // Minus
+    {logicalNotResults(), 3007, Result::Bool}, // LogicalNot
+    {unaryResults(Type::Pointer, Result::Subtype), 3008,
+     Result::Operand},                   // PtrDeref
+    {UnaryResults{}, 0, Result::Error}, // AddressOf, checked apart
+};
+static_assert(sizeof(unary_rules) / sizeof(unary_rules[0])
+                  == static_cast<std::size_t>(
+                         ast::UnaryOperator::Kind::AddressOf)
+                         + 1,
+              "one rule per unary operator");
+
+// indexed by the class of the operand, then by the one of the type it is
+// cast to
+constexpr std::array<std::array<bool, operand_classes>, operand_classes>
+castResults() {
+    constexpr bool scalar[operand_classes] = {
+        false, true, true, true, true, false, false};
+    std::array<std::array<bool, operand_classes>, operand_classes> results{};
+    for (std::size_t i = 0; i < operand_classes; ++i) {
+        for (std::size_t j = 0; j < operand_classes; ++j) {
+            results[i][j] = scalar[i] && scalar[j];
+        }
+        if (classHas(i, Type::Integral)) {
+            results[i][index(OperandClass::Pointer)] = true;
+            results[index(OperandClass::Pointer)][i] = true;
+        }
     }
-    return nullptr;
+    results[index(OperandClass::Pointer)][index(OperandClass::Pointer)]
+        = true;
+    return results;
 }
 
-Type* OpInferer::inferUnaryPlusOrMinus(Type* ty) {
-    auto int_ty = _type_manager->getIntType();
-    auto double_ty = _type_manager->getDoubleType();
+constexpr auto cast_results = castResults();
 
-    if (ty == int_ty || ty == double_ty) {
-        return ty;
+Type* resolve(Result result, TypeManager* tm, Type* lhs_ty, Type* rhs_ty) {
+    switch (result) {
+    case Result::Error:
+        return nullptr;
+    case Result::Bool:
+        return tm->getBoolType();
+    case Result::Operand:
+        return lhs_ty;
+    case Result::BoolIfSame:
+        return lhs_ty == rhs_ty ? tm->getBoolType() : nullptr;
+    case Result::Subtype:
+        return static_cast<PointerType*>(lhs_ty)->subtype;
     }
     return nullptr;
 }
 
-Type* OpInferer::inferUnaryNot(Type* ty) {
-    if (ty == _type_manager->getBoolType()) {
-        return ty;
+} // namespace
+
+OpInferer::OpInferer(TypeManager* tm) : _type_manager(tm) {
+}
+
+OpInferer::Inferred OpInferer::inferBinary(ast::BinaryOperator::Kind op,
+                                           Type* lhs_ty, Type* rhs_ty) const {
+    auto& rule = binary_rules[static_cast<std::size_t>(op)];
+    auto result
+        = rule.results[index(classOf(lhs_ty))][index(classOf(rhs_ty))];
+    if (auto ty = resolve(result, _type_manager, lhs_ty, rhs_ty)) {
+        return {ty, false, 0};
     }
-    return nullptr;
+    return {resolve(rule.fallback, _type_manager, lhs_ty, rhs_ty), true,
+            rule.error};
 }
 
-Type* OpInferer::inferUnaryPtrDeref(Type* ty) {
-    if (ty->variety == Type::Variety::Pointer) {
-        return static_cast<PointerType*>(ty)->subtype;
+OpInferer::Inferred OpInferer::inferUnary(ast::UnaryOperator::Kind op,
+                                          Type* ty) const {
+    auto& rule = unary_rules[static_cast<std::size_t>(op)];
+    auto result = rule.results[index(classOf(ty))];
+    if (auto result_ty = resolve(result, _type_manager, ty, ty)) {
+        return {result_ty, false, 0};
     }
-    return nullptr;
+    return {resolve(rule.fallback, _type_manager, ty, ty), true, rule.error};
+}
+
+bool OpInferer::canCast(Type* ty, Type* to_ty) const {
+    return ty == to_ty
+           || cast_results[index(classOf(ty))][index(classOf(to_ty))];
 }
 
 } // namespace elang
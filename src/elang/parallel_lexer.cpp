@@ -0,0 +1,209 @@
+#include <elang/parallel_lexer.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <elang/diagnostic.hpp>
+#include <elang/lexer.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+namespace elang {
+
+namespace {
+
+// begin and end are offsets in the file
+struct Chunk {
+    std::size_t begin;
+    std::size_t end; // the first token at or after end stops the chunk
+
+    // the last token is the one that stopped the chunk, eof for the last
+    // chunk
+    std::vector<Token> tokens;
+    std::vector<std::string> decoded_literals;
+    // diagnostics and the index of the token they were reported for
+    std::vector<DiagnosticEngine::Diagnostic> diagnostics;
+    std::vector<std::size_t> diagnostic_tokens;
+};
+
+void lexChunk(SourceManager* source_manager, unsigned fileid, Chunk* chunk) {
+    Lexer lexer{source_manager, fileid, chunk->begin, Lexer::Symbols::Defer};
+    DiagnosticEngine::Capture capture{&chunk->diagnostics};
+    auto start = source_manager->getLocation(fileid, 0).raw;
+    while (true) {
+        auto tok = lexer.getToken();
+        chunk->diagnostic_tokens.resize(chunk->diagnostics.size(),
+                                        chunk->tokens.size());
+        chunk->tokens.push_back(tok);
+        if (tok.loc.raw - start >= chunk->end || tok.is(Token::Kind::eof)) {
+            break;
+        }
+    }
+    chunk->decoded_literals = lexer.decodedLiterals();
+}
+
+std::vector<Chunk> splitInChunks(std::string_view buffer, unsigned jobs,
+                                 std::size_t min_chunk_size) {
+    std::size_t count = std::min<std::size_t>(
+        std::max(jobs, 1u),
+        buffer.size() / std::max<std::size_t>(min_chunk_size, 1) + 1);
+    std::size_t chunk_size = buffer.size() / count + 1;
+
+    std::vector<Chunk> chunks;
+    std::size_t begin = 0;
+    while (begin < buffer.size()) {
+        auto end = std::min(begin + chunk_size, buffer.size());
+        // cut right after a newline
+        auto newline = static_cast<const char*>(
+            std::memchr(buffer.data() + end, '\n', buffer.size() - end));
+        end = newline ? newline - buffer.data() + 1 : buffer.size();
+        chunks.emplace_back();
+        chunks.back().begin = begin;
+        chunks.back().end = end;
+        begin = end;
+    }
+    if (chunks.empty()) {
+        chunks.emplace_back();
+        chunks.back().begin = 0;
+    }
+    chunks.back().end = std::numeric_limits<std::size_t>::max();
+    return chunks;
+}
+
+class Stitcher {
+    SourceManager* _source_manager;
+    StringInterner* _interner;
+    TokenBuffer* _tokens;
+    std::vector<DiagnosticEngine::Diagnostic> _diagnostics;
+
+    // location of the token that stopped the previous chunk, first one of
+    // the next, and the diagnostics the previous chunk reported for it
+    std::uint32_t _pending_location;
+    std::vector<DiagnosticEngine::Diagnostic> _pending_diagnostics;
+
+  public:
+    Stitcher(SourceManager* source_manager, TokenBuffer* tokens)
+        : _source_manager(source_manager),
+          _interner(source_manager->getInterner()), _tokens(tokens),
+          _pending_location(0) {
+    }
+
+    // false when no token of the chunk starts where the previous one
+    // stopped
+    bool append(const Chunk& chunk, bool first) {
+        std::size_t index = 0;
+        if (!first) {
+            auto it = std::find_if(
+                chunk.tokens.begin(), chunk.tokens.end(),
+                [this](const Token& tok) {
+                    return tok.loc.raw >= _pending_location;
+                });
+            if (it == chunk.tokens.end()
+                || it->loc.raw != _pending_location) {
+                return false;
+            }
+            index = it - chunk.tokens.begin();
+            if (index + 1 == chunk.tokens.size()) {
+                // stops this chunk as well
+                return true;
+            }
+            // same token, the diagnostics of the previous chunk cover the
+            // chars skipped before it
+            push(chunk.tokens[index], chunk);
+            _diagnostics.insert(_diagnostics.end(),
+                                _pending_diagnostics.begin(),
+                                _pending_diagnostics.end());
+            ++index;
+        }
+
+        auto diagnostic = static_cast<std::size_t>(
+            std::lower_bound(chunk.diagnostic_tokens.begin(),
+                             chunk.diagnostic_tokens.end(), index)
+            - chunk.diagnostic_tokens.begin());
+        for (; index + 1 < chunk.tokens.size(); ++index) {
+            for (; diagnostic < chunk.diagnostics.size()
+                   && chunk.diagnostic_tokens[diagnostic] == index;
+                 ++diagnostic) {
+                _diagnostics.push_back(chunk.diagnostics[diagnostic]);
+            }
+            push(chunk.tokens[index], chunk);
+        }
+
+        _pending_location = chunk.tokens.back().loc.raw;
+        _pending_diagnostics.assign(chunk.diagnostics.begin() + diagnostic,
+                                    chunk.diagnostics.end());
+        return true;
+    }
+
+    SourceLocation pendingLocation() const {
+        return SourceLocation{_pending_location};
+    }
+
+    // pushes the eof token, then reports the diagnostics
+    void finish(const Chunk& last) {
+        push(last.tokens.back(), last);
+        _diagnostics.insert(_diagnostics.end(), _pending_diagnostics.begin(),
+                            _pending_diagnostics.end());
+        _source_manager->getDiagnosticEngine()->report(_diagnostics);
+    }
+
+  private:
+    // the symbols are given in token order, like the serial lexer does
+    void push(Token tok, const Chunk& chunk) {
+        if (tok.is(Token::Kind::identifier)) {
+            tok.data
+                = _interner->intern(_source_manager->getTokenSpelling(tok)).id;
+        } else if (tok.flags & Token::Flags::Decoded) {
+            tok.data = _interner->intern(chunk.decoded_literals[tok.data]).id;
+        }
+        _tokens->push(tok);
+    }
+};
+
+} // namespace
+
+void lexInParallel(SourceManager* source_manager, unsigned fileid,
+                   unsigned jobs, TokenBuffer* tokens,
+                   std::size_t min_chunk_size) {
+    auto buffer = source_manager->getFileRecord(fileid)->buffer;
+    auto chunks = splitInChunks(buffer, jobs, min_chunk_size);
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks.size() - 1);
+    for (std::size_t i = 1; i < chunks.size(); ++i) {
+        workers.emplace_back(lexChunk, source_manager, fileid, &chunks[i]);
+    }
+    lexChunk(source_manager, fileid, &chunks[0]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::size_t token_count = 0;
+    for (auto& chunk : chunks) {
+        token_count += chunk.tokens.size();
+    }
+    tokens->reserve(token_count);
+
+    Stitcher stitcher{source_manager, tokens};
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        if (!stitcher.append(chunks[i], i == 0)) {
+            // lost in a literal or a comment, start again from the last
+            // token known to be right
+            Chunk relexed;
+            relexed.begin
+                = source_manager->getFileOffset(stitcher.pendingLocation());
+            relexed.end = chunks[i].end;
+            lexChunk(source_manager, fileid, &relexed);
+            stitcher.append(relexed, false);
+            chunks[i] = std::move(relexed);
+        }
+    }
+    stitcher.finish(chunks.back());
+}
+
+} // namespace elang
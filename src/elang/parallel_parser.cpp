@@ -0,0 +1,159 @@
+#include <elang/parallel_parser.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <elang/arena.hpp>
+#include <elang/ast.hpp>
+#include <elang/ast_builder.hpp>
+#include <elang/diagnostic.hpp>
+#include <elang/parser.hpp>
+#include <elang/source_manager.hpp>
+#include <elang/token_buffer.hpp>
+
+namespace elang {
+
+namespace {
+
+using PreparsedBody = Parser::PreparsedBody;
+
+// bodies are handed to the threads by runs of consecutive ones
+constexpr std::size_t batch_size = 16;
+// Below this many bodies for each thread, the threads are started for
+// little work and do not make up for finding the bodies and copying their
+// tokens, which is about a tenth of parsing them.
+constexpr std::size_t min_bodies_per_job = 4 * batch_size;
+
+// Token ranges of the function bodies, from the opening brace to past the
+// closing one. Only the kinds are looked at: a range is a guess, which the
+// parse of the body confirms or not.
+std::vector<PreparsedBody> findBodies(TokenBuffer* tokens) {
+    std::vector<PreparsedBody> bodies;
+    for (auto i = tokens->position(); tokens->kindAt(i) != Token::Kind::eof;
+         ++i) {
+        if (tokens->kindAt(i) != Token::Kind::kw_func) {
+            continue;
+        }
+        // the body opens on the first brace out of the parameters and the
+        // return type, a semicolon there ends a declaration
+        auto open = i + 1;
+        unsigned depth = 0;
+        for (;; ++open) {
+            auto k = tokens->kindAt(open);
+            if (k == Token::Kind::l_paren || k == Token::Kind::l_square) {
+                ++depth;
+            } else if ((k == Token::Kind::r_paren
+                        || k == Token::Kind::r_square)
+                       && depth > 0) {
+                --depth;
+            } else if (k == Token::Kind::eof || k == Token::Kind::kw_func
+                       || (depth == 0
+                           && (k == Token::Kind::l_brace
+                               || k == Token::Kind::semi))) {
+                break;
+            }
+        }
+        auto end = findBodyEnd(tokens, open);
+        if (!end) {
+            i = open - 1;
+            continue;
+        }
+        bodies.push_back(PreparsedBody{open, end, nullptr});
+        i = end - 1;
+    }
+    return bodies;
+}
+
+struct Worker {
+    util::Arena arena;
+    TokenBuffer tokens;
+};
+
+// parses bodies taken from next until there are none left, and clears the
+// ones the serial parse must go through again
+void parseBodies(SourceManager* source_manager, const TokenBuffer* source,
+                 std::vector<PreparsedBody>* bodies,
+                 std::atomic<std::size_t>* next, Worker* worker) {
+    Parser parser{&worker->tokens, source_manager,
+                  ast::TreeBuilder{&worker->arena}};
+    // the first error drops the body, without the limit the recovery could
+    // loop on the eof that ends the tokens of the body
+    std::vector<DiagnosticEngine::Diagnostic> diagnostics;
+    DiagnosticEngine::Capture capture{&diagnostics, 1};
+
+    while (true) {
+        auto first = next->fetch_add(batch_size);
+        if (first >= bodies->size()) {
+            break;
+        }
+        auto last = std::min(first + batch_size, bodies->size());
+        for (auto i = first; i < last; ++i) {
+            auto& body = (*bodies)[i];
+            worker->tokens.assign(*source, body.begin, body.end);
+            try {
+                body.body = parser.parseFunctionBody();
+            } catch (const DiagnosticEngine::CaptureAborted&) {
+                diagnostics.clear();
+                body.body = nullptr;
+                continue;
+            }
+            if (worker->tokens.position() != body.end - body.begin) {
+                body.body = nullptr;
+            }
+        }
+    }
+}
+
+} // namespace
+
+ast::Module* parseInParallel(TokenBuffer* tokens, SourceManager* source_manager,
+                             unsigned jobs) {
+    Parser parser{tokens, source_manager};
+    // more threads than cores only add the cost of the pre-pass
+    if (auto cores = std::thread::hardware_concurrency()) {
+        jobs = std::min(jobs, cores);
+    }
+    if (jobs <= 1) {
+        return parser.parseMainModule();
+    }
+
+    auto bodies = findBodies(tokens);
+    jobs = std::min<std::size_t>(jobs, bodies.size() / min_bodies_per_job);
+    if (jobs <= 1) {
+        return parser.parseMainModule();
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (unsigned i = 0; i < jobs; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(jobs - 1);
+    for (unsigned i = 1; i < jobs; ++i) {
+        threads.emplace_back(parseBodies, source_manager, tokens, &bodies,
+                             &next, workers[i].get());
+    }
+    parseBodies(source_manager, tokens, &bodies, &next, workers[0].get());
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (auto& worker : workers) {
+        source_manager->getArena()->adopt(worker->arena);
+    }
+    bodies.erase(std::remove_if(bodies.begin(), bodies.end(),
+                                [](const PreparsedBody& body) {
+                                    return body.body == nullptr;
+                                }),
+                 bodies.end());
+
+    parser.usePreparsedBodies(&bodies);
+    return parser.parseMainModule();
+}
+
+} // namespace elang
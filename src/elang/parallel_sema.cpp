@@ -0,0 +1,71 @@
+#include <elang/parallel_sema.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace elang {
+
+namespace {
+
+// bodies are handed to the threads by runs of consecutive ones
+constexpr std::size_t batch_size = 16;
+
+} // namespace
+
+std::size_t SemaBodies::addBody() {
+    _bodies.push_back(Body{_declaration_diagnostics.size(), {}});
+    return _bodies.size() - 1;
+}
+
+unsigned SemaBodies::threads(unsigned jobs) const {
+    auto batches = (_bodies.size() + batch_size - 1) / batch_size;
+    return std::max<std::size_t>(1, std::min<std::size_t>(jobs, batches));
+}
+
+void SemaBodies::check(
+    unsigned threads,
+    const std::function<void(unsigned, std::size_t)>& check_body) {
+    std::atomic<std::size_t> next{0};
+    auto run = [&](unsigned thread) {
+        while (true) {
+            auto first = next.fetch_add(batch_size);
+            if (first >= _bodies.size()) {
+                break;
+            }
+            auto last = std::min(first + batch_size, _bodies.size());
+            for (auto i = first; i < last; ++i) {
+                DiagnosticEngine::Capture capture{&_bodies[i].diagnostics};
+                check_body(thread, i);
+            }
+        }
+    };
+
+    std::vector<std::thread> others;
+    others.reserve(threads - 1);
+    for (unsigned thread = 1; thread < threads; ++thread) {
+        others.emplace_back(run, thread);
+    }
+    run(0);
+    for (auto& other : others) {
+        other.join();
+    }
+}
+
+void SemaBodies::report(DiagnosticEngine* diag_engine) {
+    std::vector<Diagnostic> diagnostics;
+    auto declarations = _declaration_diagnostics.begin();
+    for (auto& body : _bodies) {
+        auto before = _declaration_diagnostics.begin()
+                      + body.declarations_before;
+        diagnostics.insert(diagnostics.end(), declarations, before);
+        declarations = before;
+        diagnostics.insert(diagnostics.end(), body.diagnostics.begin(),
+                           body.diagnostics.end());
+    }
+    diagnostics.insert(diagnostics.end(), declarations,
+                       _declaration_diagnostics.end());
+    diag_engine->report(diagnostics);
+}
+
+} // namespace elang
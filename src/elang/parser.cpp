@@ -1,86 +1,274 @@
 #include <elang/parser.hpp>
 
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+
 #include <elang/source_manager.hpp>
-#include <elang/lexer.hpp>
+#include <elang/token_buffer.hpp>
 #include <elang/diagnostic.hpp>
 
 namespace elang {
 
-Parser::Parser(Lexer* lexer, SourceManager* sm)
-    : _lexer(lexer), _type_manager(sm->getTypeManager()),
-      _diag_engine(sm->getDiagnosticEngine()) {
+namespace {
+
+// Binding power of the infix and postfix operators, loosest first. None
+// is below any minimum, so that a token which isn't one ends an expression.
+struct Precedence {
+    enum : std::uint8_t {
+        None,
+        Assignment,
+        LogicalOr,
+        LogicalAnd,
+        Relational,
+        Additive,
+        Multiplicative,
+        Cast,
+        Max
+    };
+};
+
+// A non-associative operator doesn't chain with one of its own level:
+// `a < b < c` and `x as int as int` stop after the first operator.
+enum class Associativity : std::uint8_t { Left, Right, None };
+
+struct OperatorInfo {
+    std::uint8_t precedence = Precedence::None;
+    Associativity associativity = Associativity::Left;
+    bool is_cast = false;
+    ast::BinaryOperator::Kind binary_kind = ast::BinaryOperator::Kind::Assign;
+    bool is_prefix = false;
+    ast::UnaryOperator::Kind unary_kind = ast::UnaryOperator::Kind::Plus;
+};
+
+constexpr std::size_t token_kind_count = 0
+#define TOK(X) +1
+#include <elang/tokenkind.def>
+    ;
+
+constexpr std::size_t toIndex(Token::Kind kind) {
+    return static_cast<std::size_t>(kind);
+}
+
+using OperatorTable = std::array<OperatorInfo, token_kind_count>;
+
+constexpr void addBinary(OperatorTable& table, Token::Kind tok_kind,
+                         std::uint8_t precedence, Associativity associativity,
+                         ast::BinaryOperator::Kind kind) {
+    auto& op = table[toIndex(tok_kind)];
+    op.precedence = precedence;
+    op.associativity = associativity;
+    op.binary_kind = kind;
+}
+
+constexpr void addPrefix(OperatorTable& table, Token::Kind tok_kind,
+                         ast::UnaryOperator::Kind kind) {
+    auto& op = table[toIndex(tok_kind)];
+    op.is_prefix = true;
+    op.unary_kind = kind;
+}
+
+constexpr OperatorTable buildOperatorTable() {
+    using Tok = Token::Kind;
+    using Bin = ast::BinaryOperator::Kind;
+    using Un = ast::UnaryOperator::Kind;
+    OperatorTable table{};
+
+    addBinary(table, Tok::equal, Precedence::Assignment,
+              Associativity::Right, Bin::Assign);
+    addBinary(table, Tok::pipepipe, Precedence::LogicalOr,
+              Associativity::Left, Bin::LogicalOr);
+    addBinary(table, Tok::ampamp, Precedence::LogicalAnd,
+              Associativity::Left, Bin::LogicalAnd);
+    addBinary(table, Tok::lessequal, Precedence::Relational,
+              Associativity::None, Bin::LessOrEqual);
+    addBinary(table, Tok::less, Precedence::Relational,
+              Associativity::None, Bin::Less);
+    addBinary(table, Tok::greater, Precedence::Relational,
+              Associativity::None, Bin::Greater);
+    addBinary(table, Tok::greaterequal, Precedence::Relational,
+              Associativity::None, Bin::GreaterOrEqual);
+    addBinary(table, Tok::equalequal, Precedence::Relational,
+              Associativity::None, Bin::Equal);
+    addBinary(table, Tok::exclaimequal, Precedence::Relational,
+              Associativity::None, Bin::Different);
+    addBinary(table, Tok::plus, Precedence::Additive,
+              Associativity::Left, Bin::Add);
+    addBinary(table, Tok::minus, Precedence::Additive,
+              Associativity::Left, Bin::Minus);
+    addBinary(table, Tok::star, Precedence::Multiplicative,
+              Associativity::Left, Bin::Times);
+    addBinary(table, Tok::slash, Precedence::Multiplicative,
+              Associativity::Left, Bin::Divide);
+    addBinary(table, Tok::percent, Precedence::Multiplicative,
+              Associativity::Left, Bin::Modulo);
+
+    auto& as = table[toIndex(Tok::kw_as)];
+    as.precedence = Precedence::Cast;
+    as.associativity = Associativity::None;
+    as.is_cast = true;
+
+    // a prefix operator applies to a subscript expression, it binds
+    // tighter than any infix one
+    addPrefix(table, Tok::plus, Un::Plus);
+    addPrefix(table, Tok::minus, Un::Minus);
+    addPrefix(table, Tok::exclaim, Un::LogicalNot);
+    addPrefix(table, Tok::star, Un::PtrDeref);
+    addPrefix(table, Tok::amp, Un::AddressOf);
+    return table;
 }
 
-std::unique_ptr<ast::Module> Parser::parseMainModule() {
-    auto loc = _lexer->peekToken().location;
-    std::vector<std::unique_ptr<ast::Declaration>> declarations;
-    while (_lexer->peekToken().isNot(Token::Kind::eof)) {
-        declarations.push_back(parseDeclaration());
+constexpr OperatorTable operator_table = buildOperatorTable();
+
+} // namespace
+
+template <class Builder>
+BasicParser<Builder>::BasicParser(TokenBuffer* tokens, SourceManager* sm)
+    : _tokens(tokens), _source_manager(sm), _type_manager(sm->getTypeManager()),
+      _diag_engine(sm->getDiagnosticEngine()), _builder(sm),
+      _preparsed(nullptr), _next_preparsed(0), _body_loader(nullptr) {
+}
+
+template <class Builder>
+BasicParser<Builder>::BasicParser(TokenBuffer* tokens, SourceManager* sm,
+                                  Builder builder)
+    : _tokens(tokens), _source_manager(sm), _type_manager(sm->getTypeManager()),
+      _diag_engine(sm->getDiagnosticEngine()), _builder(std::move(builder)),
+      _preparsed(nullptr), _next_preparsed(0), _body_loader(nullptr) {
+}
+
+template <class Builder>
+auto BasicParser<Builder>::parseMainModule() -> Module {
+    auto loc = _tokens->peek().location();
+    _builder.beginModule(Symbol::empty(), loc);
+    auto mark = _declarations.top();
+    while (_tokens->peekKind() != Token::Kind::eof) {
+        _declarations.push(parseDeclaration());
     }
-    return std::make_unique<ast::Module>("", std::move(declarations), loc);
+    auto main_mod = _builder.module(Symbol::empty(),
+                                    _declarations.since(mark), loc);
+    _declarations.popTo(mark);
+    return main_mod;
 }
 
-std::unique_ptr<ast::Declaration> Parser::parseDeclaration() {
-    if (_lexer->peekToken().is(Token::Kind::kw_mod)) {
-        return std::move(parseModule());
-    } else if (_lexer->peekToken().is(Token::Kind::kw_func)) {
-        return std::move(parseFunctionDeclaration());
+template <class Builder>
+auto BasicParser<Builder>::parseDeclaration() -> Declaration {
+    if (_tokens->peekKind() == Token::Kind::kw_mod) {
+        return parseModule();
+    } else if (_tokens->peekKind() == Token::Kind::kw_func) {
+        return parseFunctionDeclaration();
     } else {
-        auto tok = _lexer->getToken();
-        _diag_engine->report(tok.location, 2001, tok.value);
+        auto tok = _tokens->get();
+        _diag_engine->report(tok.location(), 2001, value(tok));
         return parseDeclaration();
     }
 }
 
-std::unique_ptr<ast::Module> Parser::parseModule() {
-    auto loc = accept(Token::Kind::kw_mod).location;
-    auto name = accept(Token::Kind::identifier).value;
+template <class Builder>
+auto BasicParser<Builder>::parseModule() -> Declaration {
+    auto loc = accept(Token::Kind::kw_mod).location();
+    auto name = symbol(accept(Token::Kind::identifier));
     expect(Token::Kind::l_brace);
+    _builder.beginModule(name, loc);
 
-    std::vector<std::unique_ptr<ast::Declaration>> declarations;
-    while (_lexer->peekToken().isNot(Token::Kind::r_brace)) {
-        declarations.push_back(parseDeclaration());
+    auto mark = _declarations.top();
+    while (_tokens->peekKind() != Token::Kind::r_brace) {
+        _declarations.push(parseDeclaration());
     }
     expect(Token::Kind::r_brace);
-    return std::make_unique<ast::Module>(name, std::move(declarations), loc);
+    auto mod = _builder.module(name, _declarations.since(mark), loc);
+    _declarations.popTo(mark);
+    return mod;
 }
 
-std::unique_ptr<ast::FunctionDeclaration> Parser::parseFunctionDeclaration() {
-    auto loc = accept(Token::Kind::kw_func).location;
-    auto name = accept(Token::Kind::identifier).value;
+template <class Builder>
+auto BasicParser<Builder>::parseFunctionDeclaration() -> Declaration {
+    auto loc = accept(Token::Kind::kw_func).location();
+    auto name = symbol(accept(Token::Kind::identifier));
     expect(Token::Kind::l_paren);
-    auto params = readParams();
+    auto names_mark = _symbols.top();
+    auto types_mark = _param_types.top();
+    readParams();
     expect(Token::Kind::r_paren);
 
     Type* ret_type = _type_manager->getVoidType();
-    if (_lexer->peekToken().is(Token::Kind::arrow)) {
-        _lexer->getToken();
+    if (_tokens->peekKind() == Token::Kind::arrow) {
+        _tokens->get();
         ret_type = parseQualType();
     }
 
-    FunctionType* func_ty
-        = _type_manager->getFunctionType(ret_type, params.second);
+    auto func_ty = _type_manager->getFunctionType(
+        ret_type, _param_types.since(types_mark));
+    _param_types.popTo(types_mark);
 
-    if (_lexer->peekToken().is(Token::Kind::semi)) {
-        _lexer->getToken();
-        return std::make_unique<ast::FunctionDeclaration>(name, func_ty, loc);
+    Declaration decl;
+    if (_tokens->peekKind() == Token::Kind::semi) {
+        _tokens->get();
+        decl = _builder.functionDeclaration(name, func_ty, loc);
+    } else {
+        decl = parseFunctionDefinition(name, func_ty, names_mark, loc);
     }
+    _symbols.popTo(names_mark);
+    return decl;
+}
 
-    auto content_stmt = parseCompoundStatement();
-    return std::make_unique<ast::FunctionDefinition>(
-        name, func_ty, params.first, std::move(content_stmt), loc);
+template <class Builder>
+auto BasicParser<Builder>::parseFunctionDefinition(Symbol name,
+                                                   FunctionType* func_ty,
+                                                   std::size_t names_mark,
+                                                   SourceLocation loc)
+    -> Declaration {
+    _builder.beginFunctionDefinition(name, func_ty, _symbols.since(names_mark),
+                                     loc);
+    if constexpr (Builder::lazy_bodies) {
+        if (_body_loader) {
+            auto body_token = _tokens->position();
+            // an unbalanced body is parsed right away, for its diagnostics
+            if (auto end = findBodyEnd(_tokens, body_token)) {
+                _tokens->seek(end);
+                return _builder.lazyFunctionDefinition(
+                    name, func_ty, _symbols.since(names_mark), _body_loader,
+                    body_token, loc);
+            }
+        }
+    }
+    auto content_stmt = parseFunctionBody();
+    // the body pushed and popped above the names, they are still there
+    return _builder.functionDefinition(
+        name, func_ty, _symbols.since(names_mark), content_stmt, loc);
+}
+
+template <class Builder>
+auto BasicParser<Builder>::parseFunctionBody() -> CompoundStatement {
+    if (_preparsed) {
+        // skip the bodies an error recovery went past
+        auto position = _tokens->position();
+        while (_next_preparsed < _preparsed->size()
+               && (*_preparsed)[_next_preparsed].begin < position) {
+            ++_next_preparsed;
+        }
+        if (_next_preparsed < _preparsed->size()
+            && (*_preparsed)[_next_preparsed].begin == position) {
+            auto& preparsed = (*_preparsed)[_next_preparsed++];
+            _tokens->seek(preparsed.end);
+            return preparsed.body;
+        }
+    }
+    return parseCompoundStatement();
 }
 
-Type* Parser::parseQualType() {
-    if (_lexer->peekToken().is(Token::Kind::l_square)) {
-        _lexer->getToken();
+template <class Builder>
+Type* BasicParser<Builder>::parseQualType() {
+    if (_tokens->peekKind() == Token::Kind::l_square) {
+        _tokens->get();
         auto subtype = parseQualType();
         expect(Token::Kind::semi);
-        auto size = std::stoll(accept(Token::Kind::int_literal).value);
+        auto size = number<std::size_t>(accept(Token::Kind::int_literal));
         expect(Token::Kind::r_square);
         return _type_manager->getArrayType(subtype, size);
-    } else if (_lexer->peekToken().is(Token::Kind::star)) {
-        _lexer->getToken();
+    } else if (_tokens->peekKind() == Token::Kind::star) {
+        _tokens->get();
         auto subtype = parseQualType();
         return _type_manager->getPointerType(subtype);
     } else {
@@ -88,8 +276,9 @@ Type* Parser::parseQualType() {
     }
 }
 
-BuiltinType* Parser::parseBuiltinType() {
-    auto tok = _lexer->getToken();
+template <class Builder>
+BuiltinType* BasicParser<Builder>::parseBuiltinType() {
+    auto tok = _tokens->get();
     if (tok.is(Token::Kind::kw_int)) {
         return _type_manager->getIntType();
     } else if (tok.is(Token::Kind::kw_void)) {
@@ -101,385 +290,379 @@ BuiltinType* Parser::parseBuiltinType() {
     } else if (tok.is(Token::Kind::kw_double)) {
         return _type_manager->getDoubleType();
     } else {
-        _diag_engine->report(tok.location, 2001, tok.value);
+        _diag_engine->report(tok.location(), 2001, value(tok));
         return parseBuiltinType();
     }
 }
 
-std::pair<std::vector<std::string>, std::vector<Type*>> Parser::readParams() {
-    std::vector<std::string> names;
-    std::vector<Type*> types;
-
-    if (_lexer->peekToken().isNot(Token::Kind::r_paren)) {
-        auto name = accept(Token::Kind::identifier).value;
+template <class Builder>
+void BasicParser<Builder>::readParams() {
+    if (_tokens->peekKind() != Token::Kind::r_paren) {
+        auto name = symbol(accept(Token::Kind::identifier));
         expect(Token::Kind::colon);
         auto type = parseQualType();
 
-        names.push_back(name);
-        types.push_back(type);
+        _symbols.push(name);
+        _param_types.push(type);
 
-        while (_lexer->peekToken().is(Token::Kind::comma)) {
-            _lexer->getToken();
-            auto name = accept(Token::Kind::identifier).value;
+        while (_tokens->peekKind() == Token::Kind::comma) {
+            _tokens->get();
+            auto name = symbol(accept(Token::Kind::identifier));
             expect(Token::Kind::colon);
             auto type = parseQualType();
 
-            names.push_back(name);
-            types.push_back(type);
+            _symbols.push(name);
+            _param_types.push(type);
         }
     }
-    return std::make_pair(names, types);
 }
 
-std::unique_ptr<ast::Statement> Parser::parseStatement() {
-    if (_lexer->peekToken().is(Token::Kind::kw_let)) {
-        return std::move(parseLetStatement());
-    } else if (_lexer->peekToken().is(Token::Kind::kw_if)) {
-        return std::move(parseSelectionStatement());
-    } else if (_lexer->peekToken().is(Token::Kind::kw_while)) {
-        return std::move(parseIterationStatement());
-    } else if (_lexer->peekToken().is(Token::Kind::kw_return)) {
-        return std::move(parseReturnStatement());
-    } else if (_lexer->peekToken().is(Token::Kind::l_brace)) {
-        return std::move(parseCompoundStatement());
+template <class Builder>
+auto BasicParser<Builder>::parseStatement() -> Statement {
+    if (_tokens->peekKind() == Token::Kind::kw_let) {
+        return parseLetStatement();
+    } else if (_tokens->peekKind() == Token::Kind::kw_if) {
+        return parseSelectionStatement();
+    } else if (_tokens->peekKind() == Token::Kind::kw_while) {
+        return parseIterationStatement();
+    } else if (_tokens->peekKind() == Token::Kind::kw_return) {
+        return parseReturnStatement();
+    } else if (_tokens->peekKind() == Token::Kind::l_brace) {
+        return parseCompoundStatement();
     } else {
-        return std::move(parseExpressionStatement());
+        return parseExpressionStatement();
     }
 }
 
-std::unique_ptr<ast::LetStatement> Parser::parseLetStatement() {
-    auto loc = accept(Token::Kind::kw_let).location;
-    auto name = accept(Token::Kind::identifier).value;
+template <class Builder>
+auto BasicParser<Builder>::parseLetStatement() -> Statement {
+    auto loc = accept(Token::Kind::kw_let).location();
+    auto name = symbol(accept(Token::Kind::identifier));
 
     Type* type = nullptr;
-    std::unique_ptr<ast::Expression> init_expr = nullptr;
+    Expression init_expr = Builder::none;
 
-    auto tok = _lexer->getToken();
+    auto tok = _tokens->get();
     if (tok.is(Token::Kind::colon)) {
         type = parseQualType();
-        if (_lexer->peekToken().is(Token::Kind::equal)) {
-            _lexer->getToken();
+        if (_tokens->peekKind() == Token::Kind::equal) {
+            _tokens->get();
             init_expr = parseExpression();
         }
     } else if (tok.is(Token::Kind::equal)) {
         init_expr = parseExpression();
     } else {
-        _diag_engine->report(loc, 2002, tok.value);
+        _diag_engine->report(loc, 2002, value(tok));
     }
 
     expect(Token::Kind::semi);
-    return std::make_unique<ast::LetStatement>(type, name, std::move(init_expr),
-                                               loc);
+    return _builder.letStatement(type, name, init_expr, loc);
 }
 
-std::unique_ptr<ast::CompoundStatement> Parser::parseCompoundStatement() {
-    auto loc = accept(Token::Kind::l_brace).location;
-    std::vector<std::unique_ptr<ast::Statement>> stmts;
-    while (_lexer->peekToken().isNot(Token::Kind::r_brace)) {
-        stmts.push_back(std::move(parseStatement()));
+template <class Builder>
+auto BasicParser<Builder>::parseCompoundStatement() -> CompoundStatement {
+    auto loc = accept(Token::Kind::l_brace).location();
+    _builder.beginCompoundStatement(loc);
+    auto mark = _statements.top();
+    while (_tokens->peekKind() != Token::Kind::r_brace) {
+        _statements.push(parseStatement());
     }
     expect(Token::Kind::r_brace);
-    return std::make_unique<ast::CompoundStatement>(std::move(stmts), loc);
+    auto stmt = _builder.compoundStatement(_statements.since(mark), loc);
+    _statements.popTo(mark);
+    return stmt;
 }
 
-std::unique_ptr<ast::SelectionStatement> Parser::parseSelectionStatement() {
-    auto loc = accept(Token::Kind::kw_if).location;
-    auto condition = parseExpression();
+template <class Builder>
+auto BasicParser<Builder>::parseSelectionStatement() -> Statement {
+    auto loc = accept(Token::Kind::kw_if).location();
+    auto condition = _builder.selectionCondition(parseExpression(), loc);
     auto stmt = parseCompoundStatement();
 
-    std::vector<std::pair<std::unique_ptr<ast::Expression>,
-                          std::unique_ptr<ast::CompoundStatement>>> choices;
-    choices.emplace_back(std::move(condition), std::move(stmt));
+    auto mark = _choices.top();
+    _choices.push({condition, stmt});
 
-    std::unique_ptr<ast::CompoundStatement> else_stmt{nullptr};
-    while (_lexer->peekToken().is(Token::Kind::kw_else)) {
-        _lexer->getToken();
-        if (_lexer->peekToken().is(Token::Kind::kw_if)) {
-            _lexer->getToken();
-            auto condition = parseExpression();
+    CompoundStatement else_stmt = Builder::none;
+    while (_tokens->peekKind() == Token::Kind::kw_else) {
+        _tokens->get();
+        if (_tokens->peekKind() == Token::Kind::kw_if) {
+            _tokens->get();
+            auto condition = _builder.selectionCondition(parseExpression(),
+                                                         loc);
             auto stmt = parseCompoundStatement();
-            choices.emplace_back(std::move(condition), std::move(stmt));
+            _choices.push({condition, stmt});
         } else {
             else_stmt = parseCompoundStatement();
             break;
         }
     }
-    return std::make_unique<ast::SelectionStatement>(std::move(choices),
-                                                     std::move(else_stmt), loc);
+    auto selection_stmt = _builder.selectionStatement(_choices.since(mark),
+                                                      else_stmt, loc);
+    _choices.popTo(mark);
+    return selection_stmt;
 }
 
-std::unique_ptr<ast::IterationStatement> Parser::parseIterationStatement() {
-    auto loc = accept(Token::Kind::kw_while).location;
-    auto condition = parseExpression();
+template <class Builder>
+auto BasicParser<Builder>::parseIterationStatement() -> Statement {
+    auto loc = accept(Token::Kind::kw_while).location();
+    auto condition = _builder.iterationCondition(parseExpression(), loc);
     auto stmt = parseCompoundStatement();
-    return std::make_unique<ast::IterationStatement>(std::move(condition),
-                                                     std::move(stmt), loc);
+    return _builder.iterationStatement(condition, stmt, loc);
 }
 
-std::unique_ptr<ast::ReturnStatement> Parser::parseReturnStatement() {
-    auto loc = accept(Token::Kind::kw_return).location;
-    std::unique_ptr<ast::Expression> expr{nullptr};
-    if (_lexer->peekToken().isNot(Token::Kind::semi)) {
+template <class Builder>
+auto BasicParser<Builder>::parseReturnStatement() -> Statement {
+    auto loc = accept(Token::Kind::kw_return).location();
+    Expression expr = Builder::none;
+    if (_tokens->peekKind() != Token::Kind::semi) {
         expr = parseExpression();
     }
     expect(Token::Kind::semi);
-    return std::make_unique<ast::ReturnStatement>(std::move(expr), loc);
+    return _builder.returnStatement(expr, loc);
 }
 
-std::unique_ptr<ast::ExpressionStatement> Parser::parseExpressionStatement() {
-    std::unique_ptr<ast::Expression> expr{nullptr};
-    SourceLocation loc = _lexer->peekToken().location; // just to initalize
-    if (_lexer->peekToken().isNot(Token::Kind::semi)) {
+template <class Builder>
+auto BasicParser<Builder>::parseExpressionStatement() -> Statement {
+    Expression expr = Builder::none;
+    SourceLocation loc = _tokens->peek().location(); // just to initalize
+    if (_tokens->peekKind() != Token::Kind::semi) {
         expr = parseExpression();
-        loc = expr->location;
+        loc = _builder.location(expr);
         expect(Token::Kind::semi);
     } else {
-        loc = accept(Token::Kind::semi).location;
-    }
-    return std::make_unique<ast::ExpressionStatement>(std::move(expr), loc);
-}
-
-std::unique_ptr<ast::Expression> Parser::parseExpression() {
-    auto rhs_expr = parseLogicalOrExpression();
-    if (_lexer->peekToken().is(Token::Kind::equal)) {
-        auto loc = _lexer->getToken().location;
-        auto lhs_expr = parseExpression();
-        rhs_expr = std::make_unique<ast::BinaryOperator>(
-            ast::BinaryOperator::Kind::Assign, std::move(rhs_expr),
-            std::move(lhs_expr), loc);
-    }
-    return std::move(rhs_expr);
-}
-
-std::unique_ptr<ast::Expression> Parser::parseLogicalOrExpression() {
-    auto rhs_expr = parseLogicalAndExpression();
-    while (_lexer->peekToken().is(Token::Kind::pipepipe)) {
-        auto loc = _lexer->getToken().location;
-        auto lhs_expr = parseLogicalAndExpression();
-        rhs_expr = std::make_unique<ast::BinaryOperator>(
-            ast::BinaryOperator::Kind::LogicalOr, std::move(rhs_expr),
-            std::move(lhs_expr), loc);
-    }
-    return std::move(rhs_expr);
-}
-
-std::unique_ptr<ast::Expression> Parser::parseLogicalAndExpression() {
-    auto rhs_expr = parseSimpleExpression();
-    while (_lexer->peekToken().is(Token::Kind::ampamp)) {
-        auto loc = _lexer->getToken().location;
-        auto lhs_expr = parseSimpleExpression();
-        rhs_expr = std::make_unique<ast::BinaryOperator>(
-            ast::BinaryOperator::Kind::LogicalAnd, std::move(rhs_expr),
-            std::move(lhs_expr), loc);
-    }
-    return std::move(rhs_expr);
-}
-
-std::unique_ptr<ast::Expression> Parser::parseSimpleExpression() {
-    auto rhs_expr = parseAddExpression();
-    if (_lexer->peekToken().isOneOf(
-            Token::Kind::lessequal, Token::Kind::less, Token::Kind::greater,
-            Token::Kind::greaterequal, Token::Kind::equalequal,
-            Token::Kind::exclaimequal)) {
-        auto loc = _lexer->peekToken().location;
-        ast::BinaryOperator::Kind kind;
-        auto tok_kind = _lexer->getToken().kind;
-        if (tok_kind == Token::Kind::lessequal)
-            kind = ast::BinaryOperator::Kind::LessOrEqual;
-        else if (tok_kind == Token::Kind::less)
-            kind = ast::BinaryOperator::Kind::Less;
-        else if (tok_kind == Token::Kind::greater)
-            kind = ast::BinaryOperator::Kind::Greater;
-        else if (tok_kind == Token::Kind::greaterequal)
-            kind = ast::BinaryOperator::Kind::GreaterOrEqual;
-        else if (tok_kind == Token::Kind::equalequal)
-            kind = ast::BinaryOperator::Kind::Equal;
-        else if (tok_kind == Token::Kind::exclaimequal)
-            kind = ast::BinaryOperator::Kind::Different;
-
-        auto lhs_expr = parseAddExpression();
-        rhs_expr = std::make_unique<ast::BinaryOperator>(
-            kind, std::move(rhs_expr), std::move(lhs_expr), loc);
-    }
-    return std::move(rhs_expr);
-}
-
-std::unique_ptr<ast::Expression> Parser::parseAddExpression() {
-    auto rhs_expr = parseTermExpression();
-    while (_lexer->peekToken().isOneOf(Token::Kind::plus, Token::Kind::minus)) {
-        auto loc = _lexer->peekToken().location;
-        ast::BinaryOperator::Kind kind;
-        auto tok_kind = _lexer->getToken().kind;
-        if (tok_kind == Token::Kind::plus)
-            kind = ast::BinaryOperator::Kind::Add;
-        else if (tok_kind == Token::Kind::minus)
-            kind = ast::BinaryOperator::Kind::Minus;
-
-        auto lhs_expr = parseTermExpression();
-        rhs_expr = std::make_unique<ast::BinaryOperator>(
-            kind, std::move(rhs_expr), std::move(lhs_expr), loc);
-    }
-    return std::move(rhs_expr);
-}
-
-std::unique_ptr<ast::Expression> Parser::parseTermExpression() {
-    auto rhs_expr = parseCastExpression();
-    while (_lexer->peekToken().isOneOf(Token::Kind::star, Token::Kind::slash,
-                                       Token::Kind::percent)) {
-        auto loc = _lexer->peekToken().location;
-        ast::BinaryOperator::Kind kind;
-        auto tok_kind = _lexer->getToken().kind;
-        if (tok_kind == Token::Kind::star)
-            kind = ast::BinaryOperator::Kind::Times;
-        else if (tok_kind == Token::Kind::slash)
-            kind = ast::BinaryOperator::Kind::Divide;
-        else if (tok_kind == Token::Kind::percent)
-            kind = ast::BinaryOperator::Kind::Modulo;
-
-        auto lhs_expr = parseCastExpression();
-        rhs_expr = std::make_unique<ast::BinaryOperator>(
-            kind, std::move(rhs_expr), std::move(lhs_expr), loc);
-    }
-    return std::move(rhs_expr);
-}
-
-std::unique_ptr<ast::Expression> Parser::parseCastExpression() {
-    auto casted = parseUnaryExpression();
-    if (_lexer->peekToken().is(Token::Kind::kw_as)) {
-        auto loc = _lexer->getToken().location;
-        auto to_type = parseQualType();
-        return std::make_unique<ast::CastExpression>(std::move(casted), to_type,
-                                                     loc);
-    }
-    return std::move(casted);
-}
-
-std::unique_ptr<ast::Expression> Parser::parseUnaryExpression() {
-    if (_lexer->peekToken().isOneOf(Token::Kind::plus, Token::Kind::minus,
-                                    Token::Kind::exclaim, Token::Kind::star,
-                                    Token::Kind::amp)) {
-        auto loc = _lexer->peekToken().location;
-        ast::UnaryOperator::Kind kind;
-        auto tok_kind = _lexer->getToken().kind;
-        if (tok_kind == Token::Kind::plus)
-            kind = ast::UnaryOperator::Kind::Plus;
-        else if (tok_kind == Token::Kind::minus)
-            kind = ast::UnaryOperator::Kind::Minus;
-        else if (tok_kind == Token::Kind::exclaim)
-            kind = ast::UnaryOperator::Kind::LogicalNot;
-        else if (tok_kind == Token::Kind::star)
-            kind = ast::UnaryOperator::Kind::PtrDeref;
-        else if (tok_kind == Token::Kind::amp)
-            kind = ast::UnaryOperator::Kind::AddressOf;
+        loc = accept(Token::Kind::semi).location();
+    }
+    return _builder.expressionStatement(expr, loc);
+}
+
+template <class Builder>
+auto BasicParser<Builder>::parseExpression() -> Expression {
+    return parseOperatorExpression(Precedence::Assignment);
+}
+
+// Precedence climbing: the operands of an operator are parsed with a
+// minimum precedence one above its own (its own for a right-associative
+// one), so tighter operators end up deeper in the tree. After a
+// non-associative operator only looser ones may follow.
+template <class Builder>
+auto BasicParser<Builder>::parseOperatorExpression(unsigned min_precedence)
+    -> Expression {
+    auto expr = parseUnaryExpression();
+    unsigned max_precedence = Precedence::Max;
+    while (true) {
+        auto& op = operator_table[toIndex(_tokens->peekKind())];
+        if (op.precedence < min_precedence
+            || op.precedence >= max_precedence) {
+            return expr;
+        }
+
+        auto loc = _tokens->get().location();
+        if (op.is_cast) {
+            auto to_type = parseQualType();
+            expr = _builder.castExpression(expr, to_type, loc);
+        } else {
+            unsigned rhs_precedence = op.precedence;
+            if (op.associativity != Associativity::Right) {
+                ++rhs_precedence;
+            }
+            auto rhs_expr = parseOperatorExpression(rhs_precedence);
+            expr = _builder.binaryOperator(op.binary_kind, expr, rhs_expr,
+                                           loc);
+        }
+        max_precedence = op.precedence;
+        if (op.associativity != Associativity::None) {
+            ++max_precedence;
+        }
+    }
+}
 
+template <class Builder>
+auto BasicParser<Builder>::parseUnaryExpression() -> Expression {
+    auto& op = operator_table[toIndex(_tokens->peekKind())];
+    if (op.is_prefix) {
+        auto loc = _tokens->get().location();
         auto expr = parseSubscriptExpression();
-        return std::make_unique<ast::UnaryOperator>(kind, std::move(expr), loc);
+        return _builder.unaryOperator(op.unary_kind, expr, loc);
     }
     return parseSubscriptExpression();
 }
 
-std::unique_ptr<ast::Expression> Parser::parseSubscriptExpression() {
+template <class Builder>
+auto BasicParser<Builder>::parseSubscriptExpression() -> Expression {
     auto expr = parseFactorExpression();
-    while (_lexer->peekToken().is(Token::Kind::l_square)) {
-        auto loc = _lexer->getToken().location;
+    while (_tokens->peekKind() == Token::Kind::l_square) {
+        auto loc = _tokens->get().location();
         auto index = parseExpression();
-        expr = std::make_unique<ast::SubscriptExpression>(
-            std::move(expr), std::move(index), loc);
+        expr = _builder.subscriptExpression(expr, index, loc);
         expect(Token::Kind::r_square);
     }
-    return std::move(expr);
+    return expr;
 }
 
-std::unique_ptr<ast::Expression> Parser::parseFactorExpression() {
-    if (_lexer->peekToken().is(Token::Kind::l_paren)) {
-        _lexer->getToken();
+template <class Builder>
+auto BasicParser<Builder>::parseFactorExpression() -> Expression {
+    switch (_tokens->peekKind()) {
+    case Token::Kind::l_paren: {
+        _tokens->get();
         auto expr = parseExpression();
         expect(Token::Kind::r_paren);
-        return std::move(expr);
-    } else if (_lexer->peekToken().is(Token::Kind::int_literal)) {
-        auto tok = _lexer->getToken();
-        return std::make_unique<ast::IntLiteral>(std::stoll(tok.value),
-                                                 tok.location);
-    } else if (_lexer->peekToken().is(Token::Kind::char_literal)) {
-        auto tok = _lexer->getToken();
-        return std::make_unique<ast::CharLiteral>(tok.value.front(),
-                                                  tok.location);
-    } else if (_lexer->peekToken().is(Token::Kind::double_literal)) {
-        auto tok = _lexer->getToken();
-        return std::make_unique<ast::DoubleLiteral>(std::stod(tok.value),
-                                                    tok.location);
-    } else if (_lexer->peekToken().is(Token::Kind::string_literal)) {
-        auto tok = _lexer->getToken();
-        return std::make_unique<ast::StringLiteral>(tok.value, tok.location);
-    } else if (_lexer->peekToken().is(Token::Kind::boolean_literal)) {
-        auto tok = _lexer->getToken();
-        return std::make_unique<ast::BoolLiteral>(tok.value == "true",
-                                                  tok.location);
-    } else {
+        return expr;
+    }
+    case Token::Kind::int_literal: {
+        auto tok = _tokens->get();
+        return _builder.intLiteral(number<unsigned long>(tok),
+                                   tok.location());
+    }
+    case Token::Kind::char_literal: {
+        auto tok = _tokens->get();
+        return _builder.charLiteral(value(tok).front(), tok.location());
+    }
+    case Token::Kind::double_literal: {
+        auto tok = _tokens->get();
+        return _builder.doubleLiteral(number<double>(tok), tok.location());
+    }
+    case Token::Kind::string_literal: {
+        auto tok = _tokens->get();
+        return _builder.stringLiteral(value(tok), tok.location());
+    }
+    case Token::Kind::boolean_literal: {
+        auto tok = _tokens->get();
+        return _builder.boolLiteral(value(tok) == "true", tok.location());
+    }
+    default: {
         auto id_expr = parseIdentifierReference();
-        if (_lexer->peekToken().is(Token::Kind::l_paren)) {
-            _lexer->getToken();
-            auto args = parseArgs();
-            auto loc = accept(Token::Kind::r_paren).location;
-            return std::make_unique<ast::CallExpression>(std::move(id_expr),
-                                                         std::move(args), loc);
+        if (_tokens->peekKind() == Token::Kind::l_paren) {
+            _tokens->get();
+            auto mark = _args.top();
+            parseArgs();
+            auto loc = accept(Token::Kind::r_paren).location();
+            auto call = _builder.callExpression(id_expr, _args.since(mark),
+                                                loc);
+            _args.popTo(mark);
+            return call;
         }
-        return std::move(id_expr);
+        return id_expr;
+    }
     }
 }
 
-std::unique_ptr<ast::IdentifierReference> Parser::parseIdentifierReference() {
-    std::string identifier_name;
-    std::vector<std::string> module_path;
-    SourceLocation loc = _lexer->peekToken().location;
+template <class Builder>
+auto BasicParser<Builder>::parseIdentifierReference()
+    -> IdentifierReference {
+    Symbol identifier_name;
+    auto mark = _symbols.top();
+    SourceLocation loc = _tokens->peek().location();
 
-    if (_lexer->peekToken().is(Token::Kind::coloncolon)) {
-        _lexer->getToken();
-        module_path.push_back("");
+    if (_tokens->peekKind() == Token::Kind::coloncolon) {
+        _tokens->get();
+        _symbols.push(Symbol::empty());
     }
 
     auto tok = accept(Token::Kind::identifier);
-    loc = tok.location;
-    identifier_name = tok.value;
+    loc = tok.location();
+    identifier_name = symbol(tok);
 
-    while (_lexer->peekToken().is(Token::Kind::coloncolon)) {
-        _lexer->getToken();
-        module_path.push_back(identifier_name);
+    while (_tokens->peekKind() == Token::Kind::coloncolon) {
+        _tokens->get();
+        _symbols.push(identifier_name);
         tok = accept(Token::Kind::identifier);
-        loc = tok.location;
-        identifier_name = tok.value;
+        loc = tok.location();
+        identifier_name = symbol(tok);
     }
 
-    return std::make_unique<ast::IdentifierReference>(identifier_name,
-                                                      module_path, loc);
+    auto id_ref = _builder.identifierReference(identifier_name,
+                                               _symbols.since(mark), loc);
+    _symbols.popTo(mark);
+    return id_ref;
 }
 
-std::vector<std::unique_ptr<ast::Expression>> Parser::parseArgs() {
-    std::vector<std::unique_ptr<ast::Expression>> args;
-    if (_lexer->peekToken().isNot(Token::Kind::r_paren)) {
-        args.push_back(std::move(parseExpression()));
-        while (_lexer->peekToken().is(Token::Kind::comma)) {
-            _lexer->getToken();
-            args.push_back(std::move(parseExpression()));
+template <class Builder>
+void BasicParser<Builder>::parseArgs() {
+    if (_tokens->peekKind() != Token::Kind::r_paren) {
+        _args.push(parseExpression());
+        while (_tokens->peekKind() == Token::Kind::comma) {
+            _tokens->get();
+            _args.push(parseExpression());
         }
     }
-    return std::move(args);
 }
 
-void Parser::expect(Token::Kind kind) {
-    while (!_lexer->peekToken().isOneOf(kind, Token::Kind::eof)) {
-        auto tok = _lexer->getToken();
-        _diag_engine->report(tok.location, 2001, tok.value);
+template <class Builder>
+void BasicParser<Builder>::expect(Token::Kind kind) {
+    while (!_tokens->peek().isOneOf(kind, Token::Kind::eof)) {
+        auto tok = _tokens->get();
+        _diag_engine->report(tok.location(), 2001, value(tok));
     }
-    _lexer->getToken();
+    reportEndOfFile(kind);
+    _tokens->get();
+}
+
+template <class Builder>
+std::string_view BasicParser<Builder>::value(const Token& tok) {
+    return _source_manager->getTokenValue(tok);
+}
+
+// 0 when the literal doesn't fit in T, which is reported
+template <class Builder>
+template <class T>
+T BasicParser<Builder>::number(const Token& tok) {
+    auto spelling = value(tok);
+    T number{};
+    auto result = std::from_chars(spelling.data(),
+                                  spelling.data() + spelling.size(), number);
+    if (result.ec == std::errc::result_out_of_range) {
+        _diag_engine->report(tok.location(), 2004, spelling);
+        return T{};
+    }
+    return number;
+}
+
+// the empty symbol for anything but an identifier
+template <class Builder>
+Symbol BasicParser<Builder>::symbol(const Token& tok) {
+    return tok.is(Token::Kind::identifier) ? Symbol{tok.data} : Symbol::empty();
+}
+
+template <class Builder>
+Token BasicParser<Builder>::accept(Token::Kind kind) {
+    while (!_tokens->peek().isOneOf(kind, Token::Kind::eof)) {
+        auto tok = _tokens->get();
+        _diag_engine->report(tok.location(), 2001, value(tok));
+    }
+    reportEndOfFile(kind);
+    return _tokens->get();
+}
+
+// the parser would loop forever on eof otherwise, the report never returns
+template <class Builder>
+void BasicParser<Builder>::reportEndOfFile(Token::Kind expected) {
+    if (expected != Token::Kind::eof
+        && _tokens->peekKind() == Token::Kind::eof) {
+        _diag_engine->report(_tokens->peek().location(), 2003);
+    }
+}
+
+template class BasicParser<ast::TreeBuilder>;
+template class BasicParser<flat::Builder>;
+
+BodyLoader::BodyLoader(TokenBuffer* tokens, SourceManager* sm)
+    : _tokens(tokens), _parser(tokens, sm) {
+}
+
+ast::CompoundStatement* BodyLoader::load(std::size_t body_token) {
+    auto position = _tokens->position();
+    _tokens->seek(body_token);
+    auto body = _parser.parseFunctionBody();
+    _tokens->seek(position);
+    return body;
 }
 
-Token Parser::accept(Token::Kind kind) {
-    while (!_lexer->peekToken().isOneOf(kind, Token::Kind::eof)) {
-        auto tok = _lexer->getToken();
-        _diag_engine->report(tok.location, 2001, tok.value);
+std::size_t findBodyEnd(TokenBuffer* tokens, std::size_t open) {
+    auto close = tokens->closingBrace(open);
+    if (!close || tokens->hasFunctionBetween(open, close)) {
+        return 0;
     }
-    return _lexer->getToken();
+    return close + 1;
 }
 
 } // namespace elang
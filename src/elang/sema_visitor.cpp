@@ -1,110 +1,108 @@
 #include <elang/sema_visitor.hpp>
 
+#include <memory>
+
+#include <elang/arena.hpp>
 #include <elang/source_manager.hpp>
 #include <elang/type.hpp>
 #include <elang/diagnostic.hpp>
 
 namespace elang {
 
-std::unique_ptr<ast::Expression>
-addL2RCast(std::unique_ptr<ast::Expression>&& expr);
-
 namespace ast {
 
 SemaVisitor::SemaVisitor(SourceManager* sm)
     : _type_manager(sm->getTypeManager()),
-      _diag_engine(sm->getDiagnosticEngine()), _op_inferer(_type_manager) {
+      _diag_engine(sm->getDiagnosticEngine()), _interner(sm->getInterner()),
+      _arena(sm->getArena()), _op_inferer(_type_manager),
+      _globals(&_global_table), _current_module(0),
+      _current_return_ty(nullptr) {
+}
+
+SemaVisitor::SemaVisitor(const SemaVisitor& parent, util::Arena* arena)
+    : _type_manager(parent._type_manager),
+      _diag_engine(parent._diag_engine), _interner(parent._interner),
+      _arena(arena), _op_inferer(_type_manager), _globals(parent._globals),
+      _current_module(0), _current_return_ty(nullptr) {
+}
+
+struct SemaVisitor::Worker {
+    util::Arena arena;
+    SemaVisitor visitor;
+
+    explicit Worker(const SemaVisitor& parent) : visitor(parent, &arena) {
+    }
+};
+
+void SemaVisitor::check(Module* main_mod, unsigned jobs) {
+    {
+        DiagnosticEngine::Capture capture{_bodies.declarationSink()};
+        dispatch(main_mod);
+    }
+
+    auto threads = _bodies.threads(jobs);
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (unsigned thread = 1; thread < threads; ++thread) {
+        workers.push_back(std::make_unique<Worker>(*this));
+    }
+    _bodies.check(threads, [&](unsigned thread, std::size_t body) {
+        auto visitor = thread == 0 ? this : &workers[thread - 1]->visitor;
+        visitor->checkBody(_pending[body]);
+    });
+    // the casts and paths the workers made belong to the AST
+    for (auto& worker : workers) {
+        _arena->adopt(worker->arena);
+    }
+
+    _bodies.report(_diag_engine);
+}
+
+void SemaVisitor::checkBody(const PendingBody& body) {
+    auto node = body.node;
+    _current_module = body.module;
+    // duplicated parameters were reported with the declarations
+    _local_table.reset();
+    for (std::size_t i = 0; i < node->param_names.size(); ++i) {
+        _local_table.put(node->param_names[i], node->type->params_types[i]);
+    }
+    _current_return_ty = node->type->return_type;
+    dispatch(node->content_stmt);
 }
 
 void SemaVisitor::visit(BinaryOperator* node) {
-    node->lhs->accept(this);
-    node->rhs->accept(this);
+    dispatch(node->lhs);
+    dispatch(node->rhs);
     if (node->kind == BinaryOperator::Kind::Assign) {
-        if (node->lhs->type->variety != Type::Variety::LValue) {
+        if (!node->lhs->type->is(Type::LValue)) {
             _diag_engine->report(node->location, 3001);
             node->type = node->lhs->type;
             return;
         }
         auto lhs_ty = static_cast<LValueType*>(node->lhs->type)->subtype;
-        node->rhs = addL2RCast(std::move(node->rhs));
+        node->rhs = addL2RCast(node->rhs);
         if (lhs_ty != node->rhs->type) {
             _diag_engine->report(node->location, 3002, lhs_ty->toString(),
                                  node->rhs->type->toString());
         }
         node->type = lhs_ty;
     } else {
-        node->lhs = addL2RCast(std::move(node->lhs));
-        node->rhs = addL2RCast(std::move(node->rhs));
-        if (node->kind == BinaryOperator::Kind::LessOrEqual
-            || node->kind == BinaryOperator::Kind::Less
-            || node->kind == BinaryOperator::Kind::GreaterOrEqual
-            || node->kind == BinaryOperator::Kind::Greater) {
-            node->type
-                = _op_inferer.inferBinaryComp(node->lhs->type, node->rhs->type);
-            if (!node->type) {
-                _diag_engine->report(node->location, 3003,
-                                     node->lhs->type->toString(),
-                                     node->rhs->type->toString());
-                node->type = _type_manager->getBoolType();
-            }
-        } else if (node->kind == BinaryOperator::Kind::Equal
-                   || node->kind == BinaryOperator::Kind::Different) {
-            node->type = _op_inferer.inferBinaryEqualOrDifferent(
-                node->lhs->type, node->rhs->type);
-            if (!node->type) {
-                _diag_engine->report(node->location, 3003,
-                                     node->lhs->type->toString(),
-                                     node->rhs->type->toString());
-                node->type = _type_manager->getBoolType();
-            }
-        } else if (node->kind == BinaryOperator::Kind::Add
-                   || node->kind == BinaryOperator::Kind::Minus) {
-            node->type = _op_inferer.inferBinaryAddOrMinus(node->lhs->type,
-                                                           node->rhs->type);
-            if (!node->type) {
-                _diag_engine->report(node->location, 3004,
-                                     node->lhs->type->toString(),
-                                     node->rhs->type->toString());
-                node->type = node->lhs->type;
-            }
-        } else if (node->kind == BinaryOperator::Kind::Times
-                   || node->kind == BinaryOperator::Kind::Divide
-                   || node->kind == BinaryOperator::Kind::Modulo) {
-            node->type = _op_inferer.inferBinaryTimesOrDivide(node->lhs->type,
-                                                              node->rhs->type);
-            if (!node->type) {
-                _diag_engine->report(node->location, 3004,
-                                     node->lhs->type->toString(),
-                                     node->rhs->type->toString());
-                node->type = node->lhs->type;
-            }
-        } else if (node->kind == BinaryOperator::Kind::Modulo) {
-            node->type = _op_inferer.inferBinaryModulo(node->lhs->type,
-                                                       node->rhs->type);
-            if (!node->type) {
-                _diag_engine->report(node->location, 3004,
-                                     node->lhs->type->toString(),
-                                     node->rhs->type->toString());
-                node->type = node->lhs->type;
-            }
-        } else if (node->kind == BinaryOperator::Kind::LogicalAnd
-                   || node->kind == BinaryOperator::Kind::LogicalOr) {
-            node->type = _op_inferer.inferBinaryAndOrOr(node->lhs->type,
-                                                        node->rhs->type);
-            if (!node->type) {
-                _diag_engine->report(node->location, 3005,
-                                     node->lhs->type->toString(),
-                                     node->rhs->type->toString());
-                node->type = _type_manager->getBoolType();
-            }
+        node->lhs = addL2RCast(node->lhs);
+        node->rhs = addL2RCast(node->rhs);
+        auto inferred = _op_inferer.inferBinary(node->kind, node->lhs->type,
+                                                node->rhs->type);
+        if (inferred.failed) {
+            _diag_engine->report(node->location, inferred.error,
+                                 node->lhs->type->toString(),
+                                 node->rhs->type->toString());
         }
+        node->type = inferred.type;
     }
 }
 
 void SemaVisitor::visit(UnaryOperator* node) {
-    node->expr->accept(this);
+    dispatch(node->expr);
     if (node->kind == UnaryOperator::Kind::AddressOf) {
-        if (node->expr->type->variety != Type::Variety::LValue) {
+        if (!node->expr->type->is(Type::LValue)) {
             _diag_engine->report(node->location, 3009);
             node->type = node->expr->type;
             return;
@@ -112,35 +110,20 @@ void SemaVisitor::visit(UnaryOperator* node) {
         node->type = _type_manager->getPointerType(
             static_cast<LValueType*>(node->expr->type)->subtype);
     } else {
-        node->expr = addL2RCast(std::move(node->expr));
-        if (node->kind == UnaryOperator::Kind::Plus
-            || node->kind == UnaryOperator::Kind::Minus) {
-            node->type = _op_inferer.inferUnaryPlusOrMinus(node->expr->type);
-            if (!node->type) {
-                _diag_engine->report(node->location, 3006);
-                node->type = node->expr->type;
-            }
-        } else if (node->kind == UnaryOperator::Kind::LogicalNot) {
-            node->type = _op_inferer.inferUnaryNot(node->expr->type);
-            if (!node->type) {
-                _diag_engine->report(node->location, 3007);
-                node->type = _type_manager->getBoolType();
-            }
-        } else if (node->kind == UnaryOperator::Kind::PtrDeref) {
-            node->type = _op_inferer.inferUnaryPtrDeref(node->expr->type);
-            if (!node->type) {
-                _diag_engine->report(node->location, 3008);
-                node->type = node->expr->type;
-            }
+        node->expr = addL2RCast(node->expr);
+        auto inferred = _op_inferer.inferUnary(node->kind, node->expr->type);
+        if (inferred.failed) {
+            _diag_engine->report(node->location, inferred.error);
         }
+        node->type = inferred.type;
     }
 }
 
 void SemaVisitor::visit(SubscriptExpression* node) {
-    node->subscripted->accept(this);
-    node->index->accept(this);
-    node->subscripted = addL2RCast(std::move(node->subscripted));
-    node->index = addL2RCast(std::move(node->index));
+    dispatch(node->subscripted);
+    dispatch(node->index);
+    node->subscripted = addL2RCast(node->subscripted);
+    node->index = addL2RCast(node->index);
 
     if (node->index->type != _type_manager->getIntType()) {
         _diag_engine->report(node->index->location, 3010);
@@ -160,8 +143,12 @@ void SemaVisitor::visit(SubscriptExpression* node) {
 }
 
 void SemaVisitor::visit(CallExpression* node) {
-    node->func->accept(this);
-    if (node->func->type->variety != Type::Variety::Function) {
+    dispatch(node->func);
+    for (auto& arg : node->args) {
+        dispatch(arg);
+        arg = addL2RCast(arg);
+    }
+    if (!node->func->type->is(Type::Function)) {
         _diag_engine->report(node->location, 3012,
                              node->func->type->toString());
         node->type = _type_manager->getIntType();
@@ -169,14 +156,12 @@ void SemaVisitor::visit(CallExpression* node) {
     }
     auto func_ty = static_cast<FunctionType*>(node->func->type);
 
-    std::vector<Type*> args_ty;
-    args_ty.reserve(node->args.size());
-    for (auto& arg : node->args) {
-        arg->accept(this);
-        arg = addL2RCast(std::move(arg));
-        args_ty.push_back(arg->type);
+    auto& params_ty = func_ty->params_types;
+    bool args_match = node->args.size() == params_ty.size();
+    for (std::size_t i = 0; args_match && i < node->args.size(); ++i) {
+        args_match = node->args[i]->type == params_ty[i];
     }
-    if (args_ty != func_ty->params_types) {
+    if (!args_match) {
         _diag_engine->report(node->location, 3013);
         node->type = _type_manager->getIntType();
         return;
@@ -185,14 +170,20 @@ void SemaVisitor::visit(CallExpression* node) {
 }
 
 void SemaVisitor::visit(CastExpression* node) {
-    // TODO: check if this cast is possible
+    dispatch(node->casted);
+    node->casted = addL2RCast(node->casted);
+    if (!_op_inferer.canCast(node->casted->type, node->to_type)) {
+        _diag_engine->report(node->location, 3024,
+                             node->casted->type->toString(),
+                             node->to_type->toString());
+    }
     node->type = node->to_type;
 }
 
 void SemaVisitor::visit(LValueToRValueCastExpression* node) {
-    node->lvalue->accept(this);
+    dispatch(node->lvalue);
     auto ty = node->lvalue->type;
-    if (ty->variety != Type::Variety::LValue) {
+    if (!ty->is(Type::LValue)) {
         _diag_engine->report(node->location, 0);
         std::exit(-1);
     }
@@ -202,20 +193,26 @@ void SemaVisitor::visit(LValueToRValueCastExpression* node) {
 void SemaVisitor::visit(IdentifierReference* node) {
     Type* ty = nullptr;
     if (node->module_path.empty()) {
-        ty = _local_table->get(node->name);
+        ty = _local_table.get(node->name);
     }
 
     if (!ty) {
-        ty = _global_table.get(node->module_path, node->name);
+        util::Span<const Symbol> resolved_path;
+        ty = _globals->get(_current_module, node->module_path, node->name,
+                           resolved_path);
+        if (ty) {
+            node->module_path = _arena->copy(resolved_path);
+        }
     }
 
     if (!ty) {
-        _diag_engine->report(node->location, 3014, node->name);
+        _diag_engine->report(node->location, 3014,
+                             _interner->get(node->name));
         node->type = _type_manager->getIntType();
         return;
     }
 
-    if (ty->variety == Type::Variety::Function) {
+    if (ty->is(Type::Function)) {
         node->type = ty;
     } else {
         node->type = _type_manager->getLValueType(ty);
@@ -243,67 +240,68 @@ void SemaVisitor::visit(BoolLiteral* node) {
 }
 
 void SemaVisitor::visit(CompoundStatement* node) {
-    _local_table->beginScope();
+    _local_table.beginScope();
     for (auto& stmt : node->stmts) {
-        stmt->accept(this);
+        dispatch(stmt);
     }
-    _local_table->endScope();
+    _local_table.endScope();
 }
 
 void SemaVisitor::visit(LetStatement* node) {
 
     if (node->init_expr) {
-        node->init_expr->accept(this);
-        node->init_expr = addL2RCast(std::move(node->init_expr));
+        dispatch(node->init_expr);
+        node->init_expr = addL2RCast(node->init_expr);
         if (!node->type) {
             node->type = node->init_expr->type;
         } else if (node->init_expr->type != node->type) {
-            _diag_engine->report(node->location, 3015, node->name,
+            _diag_engine->report(node->location, 3015,
+                                 _interner->get(node->name),
                                  node->init_expr->type->toString(),
                                  node->type->toString());
             return;
         }
     }
 
-    if (!_local_table->put(node->name, node->type)) {
-        _diag_engine->report(node->location, 3016, node->name);
+    if (!_local_table.put(node->name, node->type)) {
+        _diag_engine->report(node->location, 3016, _interner->get(node->name));
         return;
     }
 }
 
 void SemaVisitor::visit(ExpressionStatement* node) {
     if (node->expr) {
-        node->expr->accept(this);
+        dispatch(node->expr);
     }
 }
 
 void SemaVisitor::visit(SelectionStatement* node) {
     for (auto& choice : node->choices) {
-        choice.first->accept(this);
-        choice.first = addL2RCast(std::move(choice.first));
+        dispatch(choice.first);
+        choice.first = addL2RCast(choice.first);
         if (choice.first->type != _type_manager->getBoolType()) {
             _diag_engine->report(node->location, 3021);
         }
-        choice.second->accept(this);
+        dispatch(choice.second);
     }
     if (node->else_stmt) {
-        node->else_stmt->accept(this);
+        dispatch(node->else_stmt);
     }
 }
 
 void SemaVisitor::visit(IterationStatement* node) {
-    node->condition->accept(this);
-    node->condition = addL2RCast(std::move(node->condition));
+    dispatch(node->condition);
+    node->condition = addL2RCast(node->condition);
     if (node->condition->type != _type_manager->getBoolType()) {
         _diag_engine->report(node->location, 3022);
     }
-    node->stmt->accept(this);
+    dispatch(node->stmt);
 }
 
 void SemaVisitor::visit(ReturnStatement* node) {
     if (node->expr) {
-        node->expr->accept(this);
-        node->expr = addL2RCast(std::move(node->expr));
+        dispatch(node->expr);
+        node->expr = addL2RCast(node->expr);
         if (node->expr->type != _current_return_ty) {
             _diag_engine->report(node->location, 3023,
                                  node->expr->type->toString(),
@@ -321,10 +319,10 @@ void SemaVisitor::visit(ReturnStatement* node) {
 void SemaVisitor::visit(FunctionDeclaration* node) {
     auto current_state = _global_table.getStateInModule(node->name);
     if (current_state.second == GlobalTable::State::Defined) {
-        _diag_engine->report(node->location, 3018, node->name);
+        _diag_engine->report(node->location, 3018, _interner->get(node->name));
     } else if (current_state.second == GlobalTable::State::Declared
                && current_state.first != node->type) {
-        _diag_engine->report(node->location, 3019, node->name);
+        _diag_engine->report(node->location, 3019, _interner->get(node->name));
     } else {
         _global_table.declare(node->name, node->type);
     }
@@ -333,53 +331,50 @@ void SemaVisitor::visit(FunctionDeclaration* node) {
 void SemaVisitor::visit(FunctionDefinition* node) {
     auto current_state = _global_table.getStateInModule(node->name);
     if (current_state.second == GlobalTable::State::Defined) {
-        _diag_engine->report(node->location, 3018, node->name);
+        _diag_engine->report(node->location, 3018, _interner->get(node->name));
     } else if (current_state.second == GlobalTable::State::Declared
                && current_state.first != node->type) {
-        _diag_engine->report(node->location, 3019, node->name);
+        _diag_engine->report(node->location, 3019, _interner->get(node->name));
     } else {
         _global_table.define(node->name, node->type);
-        _local_table = std::make_unique<LocalTable>();
+        _local_table.reset();
         for (std::size_t i = 0; i < node->param_names.size(); ++i) {
-            if (!_local_table->put(node->param_names[i],
+            if (!_local_table.put(node->param_names[i],
                                    node->type->params_types[i])) {
                 _diag_engine->report(node->location, 3017,
-                                     node->param_names[i]);
+                                     _interner->get(node->param_names[i]));
             }
         }
-        _current_return_ty = node->type->return_type;
-        node->content_stmt->accept(this);
-        _local_table.reset();
+        // a lazy body is parsed here, on this thread, and its diagnostics
+        // come before those of its checks
+        node->content();
+        _pending.push_back({node, _global_table.currentModule()});
+        _bodies.addBody();
     }
 }
 
 void SemaVisitor::visit(Module* node) {
     if (!_global_table.beginModule(node->name)) {
-        _diag_engine->report(node->location, 3020, node->name);
+        _diag_engine->report(node->location, 3020, _interner->get(node->name));
         return;
     }
 
     for (auto& decl : node->declarations) {
-        decl->accept(this);
+        dispatch(decl);
     }
 
     _global_table.endModule();
 }
 
-} // namespace ast
-
-// utils
-std::unique_ptr<ast::Expression>
-addL2RCast(std::unique_ptr<ast::Expression>&& expr) {
-    if (expr->type->variety == Type::Variety::LValue) {
-        auto loc = expr->location;
+Expression* SemaVisitor::addL2RCast(Expression* expr) {
+    if (expr->type->is(Type::LValue)) {
         auto ty = static_cast<LValueType*>(expr->type)->subtype;
-        auto l2r_cast = std::make_unique<ast::LValueToRValueCastExpression>(
-            std::move(expr), loc);
-        expr = std::move(l2r_cast);
+        expr = _arena->make<LValueToRValueCastExpression>(expr,
+                                                          expr->location);
         expr->type = ty;
     }
-    return std::move(expr);
+    return expr;
 }
 
+} // namespace ast
 } // namespace elang
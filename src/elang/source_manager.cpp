@@ -1,42 +1,139 @@
 #include <elang/source_manager.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <iterator>
 #include <memory>
+#include <limits>
+#include <stdexcept>
+
+#include <elang/char_scan.hpp>
 
 namespace elang {
 
+namespace {
+
+// line table offsets are 32 bits wide
+void checkBufferSize(const util::FileRecord& record) {
+    if (record.buffer.size() >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error(record.file_path + " is too large");
+    }
+}
+
+} // namespace
+
 util::FileRecord::FileRecord(std::string file_path, std::string buffer)
-    : file_path(file_path), buffer(buffer) {
+    : file_path(std::move(file_path)), _storage(std::move(buffer)) {
+    this->buffer = _storage;
+    checkBufferSize(*this);
+}
+
+util::FileRecord::FileRecord(std::string file_path, MappedFile mapping)
+    : file_path(std::move(file_path)), _mapping(std::move(mapping)) {
+    buffer = _mapping.view();
+    checkBufferSize(*this);
+}
+
+const std::vector<std::uint32_t>& util::FileRecord::getLineStarts() {
+    std::call_once(_line_starts_flag,
+                   [this] { collectLineStarts(buffer, _line_starts); });
+    return _line_starts;
+}
+
+unsigned util::FileRecord::getLine(std::size_t offset) {
+    const auto& starts = getLineStarts();
+    return std::upper_bound(starts.begin(), starts.end(), offset)
+           - starts.begin();
+}
+
+std::size_t util::FileRecord::getLineStart(unsigned line) {
+    return getLineStarts()[line - 1];
+}
+
+std::string_view util::FileRecord::getLineText(unsigned line) {
+    const auto& starts = getLineStarts();
+    std::size_t begin_pos = starts[line - 1];
+    std::size_t end_pos
+        = line < starts.size() ? starts[line] - 1 : buffer.size();
+    return buffer.substr(begin_pos, end_pos - begin_pos);
 }
 
 SourceManager::SourceManager() : _diag_engine(this, 5) {
 }
 
-unsigned SourceManager::registerFile(std::string file_path) {
-    std::ifstream input_file{file_path};
+unsigned SourceManager::registerFile(std::string file_path, LoadMode mode) {
+    if (mode == LoadMode::Map) {
+        util::MappedFile mapping{file_path};
+        if (mapping.isMapped()) {
+            return addRecord(std::make_unique<util::FileRecord>(
+                std::move(file_path), std::move(mapping)));
+        }
+    }
+
+    std::ifstream input_file{file_path, std::ios::binary};
     if (!input_file.is_open()) {
-        throw std::runtime_error("Can't read from" + file_path);
+        throw std::runtime_error("Can't read from " + file_path);
     }
 
-    std::string buffer{std::istreambuf_iterator<char>{input_file},
-                       std::istreambuf_iterator<char>{}};
+    std::string buffer;
+    input_file.seekg(0, std::ios::end);
+    auto size = input_file.tellg();
+    if (size > 0) {
+        buffer.resize(static_cast<std::size_t>(size));
+        input_file.seekg(0, std::ios::beg);
+        input_file.read(&buffer[0], size);
+        buffer.resize(static_cast<std::size_t>(input_file.gcount()));
+    } else {
+        // not seekable, fall back to a growable buffer
+        input_file.clear();
+        input_file.seekg(0, std::ios::beg);
+        buffer.assign(std::istreambuf_iterator<char>{input_file},
+                      std::istreambuf_iterator<char>{});
+    }
 
-    _records.emplace_back(file_path, buffer);
-    return _records.size() - 1;
+    return addRecord(std::make_unique<util::FileRecord>(std::move(file_path),
+                                                        std::move(buffer)));
 }
 
 unsigned SourceManager::registerStdin() {
     std::string buffer{std::istreambuf_iterator<char>{std::cin},
                        std::istreambuf_iterator<char>{}};
-    _records.emplace_back("<stdin>", buffer);
+    return registerBuffer("<stdin>", std::move(buffer));
+}
+
+unsigned SourceManager::registerBuffer(std::string name, std::string buffer) {
+    return addRecord(std::make_unique<util::FileRecord>(std::move(name),
+                                                        std::move(buffer)));
+}
+
+unsigned SourceManager::addRecord(std::unique_ptr<util::FileRecord> record) {
+    std::uint64_t start = 0;
+    if (!_records.empty()) {
+        // one past the eof of the previous file
+        start = _starts.back() + _records.back()->buffer.size() + 1;
+    }
+    if (start + record->buffer.size()
+        >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error(record->file_path
+                                 + " doesn't fit in the source locations");
+    }
+    _starts.push_back(static_cast<std::uint32_t>(start));
+    _records.push_back(std::move(record));
     return _records.size() - 1;
 }
 
+unsigned SourceManager::getFileId(SourceLocation loc) const {
+    return std::upper_bound(_starts.begin(), _starts.end(), loc.raw)
+           - _starts.begin() - 1;
+}
+
 SourceReader SourceManager::getBuffer(unsigned fileid) {
-    auto& s = _records[fileid].buffer;
-    return SourceReader{s.cbegin(), s.cend(), fileid};
+    return SourceReader{_records[fileid]->buffer, getLocation(fileid, 0)};
+}
+
+util::FileRecord* SourceManager::getFileRecord(unsigned fileid) {
+    return _records[fileid].get();
 }
 
 DiagnosticEngine* SourceManager::getDiagnosticEngine() {
@@ -47,29 +144,56 @@ TypeManager* SourceManager::getTypeManager() {
     return &_type_manager;
 }
 
-UserLocation SourceManager::getUserLocation(const SourceLocation& loc) {
-    const auto& buffer = _records[loc.fileid].buffer;
-    auto begin_pos = buffer.find_last_of('\n', loc.offset);
-
-    if (begin_pos == std::string::npos) {
-        begin_pos = 0;
-    } else {
-        ++begin_pos;
-    }
+StringInterner* SourceManager::getInterner() {
+    return &_interner;
+}
 
-    auto end_pos = buffer.find_first_of('\n', loc.offset);
-    auto line_str = buffer.substr(begin_pos, end_pos - begin_pos);
+util::Arena* SourceManager::getArena() {
+    return &_arena;
+}
 
-    unsigned line
-        = std::count(buffer.begin(), buffer.begin() + loc.offset, '\n') + 1;
-    unsigned column = loc.offset - begin_pos;
+UserLocation SourceManager::getUserLocation(const SourceLocation& loc) {
+    auto fileid = getFileId(loc);
+    auto& record = *_records[fileid];
+    std::size_t offset = loc.raw - _starts[fileid];
+    auto line = record.getLine(offset);
+    unsigned column = offset - record.getLineStart(line);
 
     bool is_eof = false;
-    if (loc.offset >= buffer.size())
+    if (offset >= record.buffer.size())
         is_eof = true;
 
-    return UserLocation{_records[loc.fileid].file_path, line, column, line_str,
-                        is_eof};
+    return UserLocation{record.file_path, line, column,
+                        record.getLineText(line), is_eof};
+}
+
+std::string_view SourceManager::getTokenSpelling(const Token& tok) {
+    auto fileid = getFileId(tok.loc);
+    return _records[fileid]->buffer.substr(tok.loc.raw - _starts[fileid],
+                                           tok.length);
+}
+
+std::string_view SourceManager::getTokenValue(const Token& tok) {
+    switch (tok.kind) {
+    case Token::Kind::identifier:
+    case Token::Kind::int_literal:
+    case Token::Kind::double_literal:
+    case Token::Kind::boolean_literal:
+        return getTokenSpelling(tok);
+    case Token::Kind::string_literal:
+    case Token::Kind::char_literal:
+        if (tok.flags & Token::Flags::Decoded) {
+            return _interner.get(Symbol{tok.data});
+        }
+        // strip the quotes
+        return getTokenSpelling(tok).substr(1, tok.length - 2);
+    default:
+        return {};
+    }
+}
+
+std::string_view SourceManager::getLineText(unsigned fileid, unsigned line) {
+    return _records[fileid]->getLineText(line);
 }
 
 } // namespace elang
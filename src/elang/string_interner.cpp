@@ -0,0 +1,81 @@
+#include <elang/string_interner.hpp>
+
+#include <cstring>
+
+namespace elang {
+
+namespace {
+
+constexpr std::size_t chunk_size = 64 * 1024;
+constexpr std::size_t initial_table_size = 1024; // power of 2
+
+// FNV-1a
+std::uint32_t hashString(std::string_view str) {
+    std::uint32_t hash = 2166136261u;
+    for (auto c : str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+} // namespace
+
+StringInterner::StringInterner()
+    : _chunk_current(nullptr), _chunk_left(0), _table(initial_table_size, 0) {
+    intern("");
+}
+
+Symbol StringInterner::intern(std::string_view str) {
+    auto hash = hashString(str);
+    auto mask = _table.size() - 1;
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+        auto entry = _table[slot];
+        if (entry == 0) {
+            std::uint32_t id = _strings.size();
+            _strings.emplace_back(store(str), str.size());
+            _hashes.push_back(hash);
+            _table[slot] = id + 1;
+            // keep the load factor under 1/2
+            if (_strings.size() * 2 > _table.size()) {
+                grow();
+            }
+            return Symbol{id};
+        }
+        if (_hashes[entry - 1] == hash && _strings[entry - 1] == str) {
+            return Symbol{entry - 1};
+        }
+    }
+}
+
+const char* StringInterner::store(std::string_view str) {
+    if (str.empty()) {
+        return ""; // no chunk yet when the constructor interns it
+    }
+    if (str.size() > _chunk_left) {
+        auto size = str.size() > chunk_size ? str.size() : chunk_size;
+        _chunks.push_back(std::make_unique<char[]>(size));
+        _chunk_current = _chunks.back().get();
+        _chunk_left = size;
+    }
+    auto stored = _chunk_current;
+    std::memcpy(_chunk_current, str.data(), str.size());
+    _chunk_current += str.size();
+    _chunk_left -= str.size();
+    return stored;
+}
+
+void StringInterner::grow() {
+    std::vector<std::uint32_t> table(_table.size() * 2, 0);
+    auto mask = table.size() - 1;
+    for (std::uint32_t id = 0; id < _strings.size(); ++id) {
+        auto slot = _hashes[id] & mask;
+        while (table[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = id + 1;
+    }
+    _table = std::move(table);
+}
+
+} // namespace elang
@@ -1,98 +1,122 @@
 #include <elang/symbol_table.hpp>
 
-inline std::string modulePathToString(const std::vector<std::string>& path) {
-    std::string result;
-    for (auto& elem : path) {
-        result += elem + "::";
-    }
-    return result;
-}
+#include <algorithm>
 
 namespace elang {
 
 LocalTable::LocalTable() {
-    _scopes.reserve(5);
     beginScope();
 }
 
-LocalTable::~LocalTable() {
-    endScope();
-}
-
 void LocalTable::beginScope() {
-    _scopes.emplace_back();
+    _scope_marks.push_back(_shadowed.size());
 }
 
 void LocalTable::endScope() {
-    _scopes.pop_back();
+    auto mark = _scope_marks.back();
+    while (_shadowed.size() > mark) {
+        auto& shadowed = _shadowed.back();
+        *_bindings.find(shadowed.name) = shadowed.binding;
+        _shadowed.pop_back();
+    }
+    _scope_marks.pop_back();
 }
 
-Type* LocalTable::get(const std::string& name) {
-    for (auto it = _scopes.rbegin(); it != _scopes.rend(); ++it) {
-        if (it->find(name) != it->end()) {
-            return (*it)[name];
-        }
+void LocalTable::reset() {
+    while (!_scope_marks.empty()) {
+        endScope();
     }
-    return nullptr;
+    beginScope();
 }
 
-bool LocalTable::put(const std::string& name, Type* ty) {
-    if (_scopes.back().find(name) != _scopes.back().end()) {
+Type* LocalTable::get(Symbol name) {
+    auto binding = _bindings.find(name);
+    return binding ? binding->type : nullptr;
+}
+
+bool LocalTable::put(Symbol name, Type* ty) {
+    auto& binding = _bindings[name];
+    if (binding.type != nullptr && binding.depth == _scope_marks.size()) {
         return false;
     }
-
-    _scopes.back()[name] = ty;
+    _shadowed.push_back({name, binding});
+    binding = {ty, _scope_marks.size()};
     return true;
 }
 
-bool GlobalTable::beginModule(const std::string& name) {
-    if (std::find(_current_module_path.begin(), _current_module_path.end(),
-                  name)
-        != _current_module_path.end()) {
+GlobalTable::GlobalTable() : _modules(1), _current_module(0) {
+    _modules[0].parent = no_module;
+}
+
+bool GlobalTable::beginModule(Symbol name) {
+    auto& path = _modules[_current_module].path;
+    if (std::find(path.begin(), path.end(), name) != path.end()) {
         return false;
     }
-    _current_module_path.push_back(name);
+    auto module = _modules[_current_module].entries[name].module;
+    if (module == no_module) {
+        module = _modules.size();
+        Module submodule;
+        submodule.parent = _current_module;
+        submodule.path = path;
+        submodule.path.push_back(name);
+        _modules[_current_module].entries[name].module = module;
+        _modules.push_back(std::move(submodule));
+    }
+    _current_module = module;
     return true;
 }
 
 void GlobalTable::endModule() {
-    _current_module_path.pop_back();
+    _current_module = _modules[_current_module].parent;
 }
 
-Type* GlobalTable::get(std::vector<std::string>& mod_path,
-                       const std::string& name) {
-    auto added_module_path = _current_module_path;
-    while (!added_module_path.empty()) {
-        auto pathed_name = modulePathToString(added_module_path)
-                           + modulePathToString(mod_path) + name;
-        if (_globals.find(pathed_name) != _globals.end()) {
-            mod_path.insert(mod_path.begin(), added_module_path.begin(),
-                            added_module_path.end());
-            return _globals[pathed_name].first;
+Type* GlobalTable::get(ModuleId module, util::Span<const Symbol> mod_path,
+                       Symbol name,
+                       util::Span<const Symbol>& resolved_path) const {
+    // from module outwards, the root excluded
+    for (; module != 0; module = _modules[module].parent) {
+        auto found = module;
+        for (auto mod_name : mod_path) {
+            auto entry = _modules[found].entries.find(mod_name);
+            found = entry ? entry->module : no_module;
+            if (found == no_module) {
+                break;
+            }
+        }
+        if (found == no_module) {
+            continue;
+        }
+        auto entry = _modules[found].entries.find(name);
+        if (entry && entry->state != State::None) {
+            auto& path = _modules[found].path;
+            resolved_path = {path.data(), path.size()};
+            return entry->type;
         }
-        added_module_path.pop_back();
     }
 
     return nullptr;
 }
 
 std::pair<Type*, GlobalTable::State>
-GlobalTable::getStateInModule(const std::string& name) {
-    auto pathed_name = modulePathToString(_current_module_path) + name;
-    if (_globals.find(pathed_name) != _globals.end()) {
-        return _globals[pathed_name];
+GlobalTable::getStateInModule(Symbol name) const {
+    auto entry = _modules[_current_module].entries.find(name);
+    if (entry) {
+        return std::make_pair(entry->type, entry->state);
     }
     return std::make_pair<Type*, State>(nullptr, State::None);
 }
 
-void GlobalTable::declare(const std::string& name, Type* ty) {
-    _globals[modulePathToString(_current_module_path) + name]
-        = std::make_pair(ty, State::Declared);
+void GlobalTable::declare(Symbol name, Type* ty) {
+    auto& entry = _modules[_current_module].entries[name];
+    entry.type = ty;
+    entry.state = State::Declared;
 }
 
-void GlobalTable::define(const std::string& name, Type* ty) {
-    _globals[modulePathToString(_current_module_path) + name]
-        = std::make_pair(ty, State::Defined);
+void GlobalTable::define(Symbol name, Type* ty) {
+    auto& entry = _modules[_current_module].entries[name];
+    entry.type = ty;
+    entry.state = State::Defined;
 }
 
 } // namespace elang
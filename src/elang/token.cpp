@@ -1,21 +1,112 @@
 #include <elang/token.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
 namespace elang {
 
-Token Token::fromIdentifier(SourceLocation loc, const std::string& id) {
-    if (id == "true" || id == "false") {
-        return Token{Token::Kind::boolean_literal, loc, id};
-    }
+namespace {
+
+// Perfect hash over the keywords of tokenkind.def (and the boolean
+// literals), built at compile time. The hash only looks at the length and
+// the first and last chars of an identifier, and the multipliers are
+// searched so that no two keywords share a slot.
 
-#define KEYWORD(X)                                                             \
-    if (id == #X) {                                                            \
-        return Token{Token::Kind::kw_##X, loc};                                \
+struct KeywordEntry {
+    const char* spelling;
+    std::size_t length;
+    Token::Kind kind;
+};
+
+constexpr std::size_t constLength(const char* str) {
+    std::size_t length = 0;
+    while (str[length]) {
+        ++length;
     }
+    return length;
+}
+
+constexpr KeywordEntry keywords[] = {
+    {"true", 4, Token::Kind::boolean_literal},
+    {"false", 5, Token::Kind::boolean_literal},
+#define KEYWORD(X) {#X, constLength(#X), Token::Kind::kw_##X},
 #include <elang/tokenkind.def>
+};
+
+constexpr std::size_t keyword_table_size = 64;
+
+constexpr std::size_t keywordHash(std::size_t length, unsigned char first,
+                                  unsigned char last, unsigned length_mul,
+                                  unsigned first_mul) {
+    return (length * length_mul + first * first_mul + last)
+           & (keyword_table_size - 1);
+}
+
+struct KeywordTable {
+    unsigned length_mul = 0;
+    unsigned first_mul = 0;
+    std::size_t min_length = ~std::size_t{0};
+    std::size_t max_length = 0;
+    // index + 1 in keywords, 0 for empty slots
+    std::array<std::uint8_t, keyword_table_size> slots{};
+};
+
+constexpr bool fillKeywordTable(KeywordTable& table) {
+    table.slots = {};
+    for (std::size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); ++i) {
+        auto& keyword = keywords[i];
+        auto slot = keywordHash(
+            keyword.length, keyword.spelling[0],
+            keyword.spelling[keyword.length - 1], table.length_mul,
+            table.first_mul);
+        if (table.slots[slot]) {
+            return false;
+        }
+        table.slots[slot] = i + 1;
+        table.min_length = std::min(table.min_length, keyword.length);
+        table.max_length = std::max(table.max_length, keyword.length);
+    }
+    return true;
+}
+
+constexpr KeywordTable buildKeywordTable() {
+    KeywordTable table;
+    for (unsigned length_mul = 1; length_mul < 64; ++length_mul) {
+        for (unsigned first_mul = 1; first_mul < 64; ++first_mul) {
+            table.length_mul = length_mul;
+            table.first_mul = first_mul;
+            if (fillKeywordTable(table)) {
+                return table;
+            }
+        }
+    }
+    table.length_mul = 0;
+    return table;
+}
+
+constexpr KeywordTable keyword_table = buildKeywordTable();
+static_assert(keyword_table.length_mul != 0,
+              "no perfect hash found for the keywords, grow the table");
+
+} // namespace
 
-    else {
-        return Token{Token::Kind::identifier, loc, id};
+Token Token::fromIdentifier(SourceLocation loc, std::string_view id) {
+    std::uint32_t length = id.size();
+    if (length >= keyword_table.min_length
+        && length <= keyword_table.max_length) {
+        auto slot = keywordHash(length, id.front(), id.back(),
+                                keyword_table.length_mul,
+                                keyword_table.first_mul);
+        if (auto index = keyword_table.slots[slot]) {
+            auto& keyword = keywords[index - 1];
+            if (keyword.length == length
+                && std::memcmp(keyword.spelling, id.data(), length) == 0) {
+                return Token{keyword.kind, loc, length};
+            }
+        }
     }
+    return Token{Token::Kind::identifier, loc, length};
 }
 
 } // namespace elang
@@ -32,7 +123,6 @@ std::ostream& operator<<(std::ostream& out, const elang::Token::Kind& kind) {
 }
 
 std::ostream& operator<<(std::ostream& out, const elang::Token& tok) {
-    // return out << "(" << tok.getSourceLocation() << ") [" << tok.getKind()
-    //           << "] " << tok.getValue();
-    return out << "[" << tok.kind << "]" << tok.value;
+    return out << "[" << tok.kind << "]" << tok.loc.raw
+               << "+" << tok.length;
 }
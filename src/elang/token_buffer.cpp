@@ -0,0 +1,104 @@
+#include <elang/token_buffer.hpp>
+
+#include <algorithm>
+
+#include <elang/lexer.hpp>
+
+namespace elang {
+
+TokenBuffer::TokenBuffer(Lexer* lexer, Mode mode)
+    : _lexer(lexer), _cursor(0), _complete(false) {
+    if (mode == Mode::Eager) {
+        while (!_complete) {
+            push(_lexer->getToken());
+        }
+    }
+}
+
+TokenBuffer::TokenBuffer()
+    : _lexer(nullptr), _cursor(0), _complete(false) {
+}
+
+std::size_t TokenBuffer::fill(std::size_t index) {
+    while (index >= _kinds.size() && !_complete) {
+        push(_lexer->getToken());
+    }
+    return index < _kinds.size() ? index : _kinds.size() - 1;
+}
+
+void TokenBuffer::reserve(std::size_t count) {
+    _kinds.reserve(count);
+    _locations.reserve(count);
+    _lengths.reserve(count);
+    _data.reserve(count);
+    _flags.reserve(count);
+}
+
+void TokenBuffer::assign(const TokenBuffer& source, std::size_t begin,
+                         std::size_t end) {
+    _lexer = nullptr;
+    _kinds.assign(source._kinds.begin() + begin, source._kinds.begin() + end);
+    _locations.assign(source._locations.begin() + begin,
+                      source._locations.begin() + end);
+    _lengths.assign(source._lengths.begin() + begin,
+                    source._lengths.begin() + end);
+    _data.assign(source._data.begin() + begin, source._data.begin() + end);
+    _flags.assign(source._flags.begin() + begin, source._flags.begin() + end);
+
+    _kinds.push_back(Token::Kind::eof);
+    _locations.push_back(source._locations[end]);
+    _lengths.push_back(0);
+    _data.push_back(0);
+    _flags.push_back(Token::Flags::None);
+    _cursor = 0;
+    _complete = true;
+    _braces.clear();
+    _open_braces.clear();
+    _functions.clear();
+}
+
+std::size_t TokenBuffer::closingBrace(std::size_t open) {
+    if (kindAt(open) != Token::Kind::l_brace) {
+        return 0;
+    }
+    auto brace = std::lower_bound(
+                     _braces.begin(), _braces.end(), open,
+                     [](const std::pair<std::uint32_t, std::uint32_t>& pair,
+                        std::size_t index) { return pair.first < index; })
+                 - _braces.begin();
+    if (static_cast<std::size_t>(brace) == _braces.size()
+        || _braces[brace].first != open) {
+        return 0; // not matched in a copy
+    }
+    while (_braces[brace].second == 0 && !_complete) {
+        push(_lexer->getToken());
+    }
+    return _braces[brace].second;
+}
+
+bool TokenBuffer::hasFunctionBetween(std::size_t first,
+                                     std::size_t last) const {
+    auto next = std::upper_bound(_functions.begin(), _functions.end(), first);
+    return next != _functions.end() && *next < last;
+}
+
+void TokenBuffer::push(const Token& tok) {
+    auto index = static_cast<std::uint32_t>(_kinds.size());
+    if (tok.is(Token::Kind::l_brace)) {
+        _open_braces.push_back(_braces.size());
+        _braces.emplace_back(index, 0);
+    } else if (tok.is(Token::Kind::r_brace) && !_open_braces.empty()) {
+        _braces[_open_braces.back()].second = index;
+        _open_braces.pop_back();
+    } else if (tok.is(Token::Kind::kw_func)) {
+        _functions.push_back(index);
+    }
+    _kinds.push_back(tok.kind);
+    _locations.push_back(tok.loc);
+    _lengths.push_back(tok.length);
+    _data.push_back(tok.data);
+    _flags.push_back(tok.flags);
+    _complete = tok.is(Token::Kind::eof);
+}
+
+} // namespace elang
@@ -1,12 +1,55 @@
 #include <elang/type.hpp>
 
+#include <algorithm>
+#include <new>
+#include <type_traits>
+
 namespace elang {
 
-Type::Type(Type::Variety var) : variety(var) {
+namespace {
+
+constexpr std::size_t initial_table_size = 256; // power of 2
+
+std::uint64_t hashCombine(std::uint64_t hash, std::uint64_t value) {
+    // splitmix64 finalizer over the running hash and the next value
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    return hash;
+}
+
+std::uint64_t hashType(Type* type) {
+    return reinterpret_cast<std::uintptr_t>(type);
 }
 
+} // namespace
+
+Type::Type(Type::Variety var, std::uint8_t properties)
+    : variety(var), properties(properties), id(0), _pointer_ty(nullptr),
+      _lvalue_ty(nullptr) {
+}
+
+namespace {
+
+std::uint8_t builtinProperties(BuiltinType::Kind kind) {
+    switch (kind) {
+    case BuiltinType::Kind::Int_ty:
+        return Type::Arithmetic | Type::Integral;
+    case BuiltinType::Kind::Double_ty:
+        return Type::Arithmetic;
+    case BuiltinType::Kind::Char_ty:
+        return Type::Integral;
+    default:
+        return 0;
+    }
+}
+
+} // namespace
+
 BuiltinType::BuiltinType(BuiltinType::Kind kind)
-    : Type(Type::Variety::Builtin), kind(kind) {
+    : Type(Type::Variety::Builtin, builtinProperties(kind)), kind(kind) {
+    id = kind;
 }
 
 std::string BuiltinType::toString() const {
@@ -25,7 +68,7 @@ std::string BuiltinType::toString() const {
 }
 
 ArrayType::ArrayType(Type* subtype, std::size_t size)
-    : Type(Type::Variety::Array), subtype(subtype), size(size) {
+    : Type(Type::Variety::Array, 0), subtype(subtype), size(size) {
 }
 
 std::string ArrayType::toString() const {
@@ -33,7 +76,7 @@ std::string ArrayType::toString() const {
 }
 
 PointerType::PointerType(Type* subtype)
-    : Type(Type::Variety::Pointer), subtype(subtype) {
+    : Type(Type::Variety::Pointer, Type::Pointer), subtype(subtype) {
 }
 
 std::string PointerType::toString() const {
@@ -41,16 +84,17 @@ std::string PointerType::toString() const {
 }
 
 LValueType::LValueType(Type* subtype)
-    : Type(Type::Variety::LValue), subtype(subtype) {
+    : Type(Type::Variety::LValue, Type::LValue), subtype(subtype) {
 }
 
 std::string LValueType::toString() const {
     return subtype->toString() + "<lval>";
 }
 
-FunctionType::FunctionType(Type* return_ty, std::vector<Type*> params_ty)
-    : Type(Type::Variety::Function), return_type(return_ty),
-      params_types(std::move(params_ty)) {
+FunctionType::FunctionType(Type* return_ty,
+                           util::Span<Type* const> params_ty)
+    : Type(Type::Variety::Function, Type::Function), return_type(return_ty),
+      params_types(params_ty) {
 }
 
 std::string FunctionType::toString() const {
@@ -72,15 +116,18 @@ std::string FunctionType::toString() const {
 TypeManager::TypeManager()
     : _void_ty(BuiltinType::Kind::Void_ty), _int_ty(BuiltinType::Kind::Int_ty),
       _double_ty(BuiltinType::Double_ty), _char_ty(BuiltinType::Kind::Char_ty),
-      _bool_ty(BuiltinType::Kind::Bool_ty) {
+      _bool_ty(BuiltinType::Kind::Bool_ty), _table(initial_table_size),
+      _table_count(0), _size(BuiltinType::count) {
 }
 
-TypeManager::~TypeManager() {
-    for (auto array_ty : _array_types)
-        delete array_ty.second;
+std::uint32_t TypeManager::size() {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _size;
+}
 
-    for (auto ptr_ty : _ptr_types)
-        delete ptr_ty.second;
+std::size_t TypeManager::bytesUsed() {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _arena.bytesUsed();
 }
 
 BuiltinType* TypeManager::getVoidType() {
@@ -104,38 +151,109 @@ BuiltinType* TypeManager::getBoolType() {
 }
 
 ArrayType* TypeManager::getArrayType(Type* subtype, std::size_t size) {
-    auto id = std::make_pair(subtype, size);
-    if (_array_types.find(id) != _array_types.end()) {
-        return _array_types[id];
-    }
-    _array_types[id] = new ArrayType(subtype, size);
-    return _array_types[id];
+    auto hash = hashCombine(hashType(subtype), size);
+    return intern<ArrayType>(
+        Type::Variety::Array, hash,
+        [&](ArrayType* array_ty) {
+            return array_ty->subtype == subtype && array_ty->size == size;
+        },
+        [&] { return make<ArrayType>(subtype, size); });
 }
 
 PointerType* TypeManager::getPointerType(Type* subtype) {
-    if (_ptr_types.find(subtype) != _ptr_types.end()) {
-        return _ptr_types[subtype];
+    if (auto ptr_ty = subtype->_pointer_ty.load(std::memory_order_acquire)) {
+        return ptr_ty;
     }
-    _ptr_types[subtype] = new PointerType(subtype);
-    return _ptr_types[subtype];
+    std::lock_guard<std::mutex> lock{_mutex};
+    auto ptr_ty = subtype->_pointer_ty.load(std::memory_order_relaxed);
+    if (!ptr_ty) {
+        ptr_ty = make<PointerType>(subtype);
+        subtype->_pointer_ty.store(ptr_ty, std::memory_order_release);
+    }
+    return ptr_ty;
 }
 
 LValueType* TypeManager::getLValueType(Type* subtype) {
-    if (_lval_types.find(subtype) != _lval_types.end()) {
-        return _lval_types[subtype];
+    if (auto lval_ty = subtype->_lvalue_ty.load(std::memory_order_acquire)) {
+        return lval_ty;
+    }
+    std::lock_guard<std::mutex> lock{_mutex};
+    auto lval_ty = subtype->_lvalue_ty.load(std::memory_order_relaxed);
+    if (!lval_ty) {
+        lval_ty = make<LValueType>(subtype);
+        subtype->_lvalue_ty.store(lval_ty, std::memory_order_release);
     }
-    _lval_types[subtype] = new LValueType(subtype);
-    return _lval_types[subtype];
+    return lval_ty;
 }
 
 FunctionType* TypeManager::getFunctionType(Type* ret_ty,
-                                           std::vector<Type*> param_ty) {
-    auto id = std::make_pair(ret_ty, param_ty);
-    if (_func_types.find(id) != _func_types.end()) {
-        return _func_types[id];
+                                           util::Span<Type* const> param_ty) {
+    auto hash = hashCombine(hashType(ret_ty), param_ty.size());
+    for (auto ty : param_ty) {
+        hash = hashCombine(hash, hashType(ty));
+    }
+    return intern<FunctionType>(
+        Type::Variety::Function, hash,
+        [&](FunctionType* func_ty) {
+            auto& params = func_ty->params_types;
+            return func_ty->return_type == ret_ty
+                   && std::equal(params.begin(), params.end(),
+                                 param_ty.begin(), param_ty.end());
+        },
+        [&] { return make<FunctionType>(ret_ty, _arena.copy(param_ty)); });
+}
+
+template <class T, class Matches, class Make>
+T* TypeManager::intern(Type::Variety variety, std::uint64_t hash,
+                       Matches matches, Make make) {
+    // the variety is part of the hash, so that an array and a function
+    // made of the same types don't share their probe sequence
+    hash = hashCombine(hash, static_cast<std::uint64_t>(variety));
+    std::lock_guard<std::mutex> lock{_mutex};
+    auto mask = _table.size() - 1;
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+        auto& entry = _table[slot];
+        if (entry.type == nullptr) {
+            auto type = make();
+            entry = {hash, type};
+            ++_table_count;
+            // keep the load factor under 1/2
+            if (_table_count * 2 > _table.size()) {
+                grow();
+            }
+            return type;
+        }
+        if (entry.hash == hash && entry.type->variety == variety
+            && matches(static_cast<T*>(entry.type))) {
+            return static_cast<T*>(entry.type);
+        }
+    }
+}
+
+template <class T, class... Args>
+T* TypeManager::make(Args&&... args) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "types are never destroyed");
+    auto type = new (_arena.allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+    type->id = _size++;
+    return type;
+}
+
+void TypeManager::grow() {
+    std::vector<Slot> table(_table.size() * 2);
+    auto mask = table.size() - 1;
+    for (auto& entry : _table) {
+        if (entry.type == nullptr) {
+            continue;
+        }
+        auto slot = entry.hash & mask;
+        while (table[slot].type != nullptr) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = entry;
     }
-    _func_types[id] = new FunctionType(ret_ty, param_ty);
-    return _func_types[id];
+    _table = std::move(table);
 }
 
 } // namespace elang
@@ -1,11 +1,13 @@
 #include <elang/user_location.hpp>
 
+#include <utility>
+
 namespace elang {
 
 UserLocation::UserLocation(std::string file_name, unsigned line,
-                           unsigned column, std::string line_string,
+                           unsigned column, std::string_view line_string,
                            bool is_eof)
-    : file_name(file_name), line(line), column(column),
+    : file_name(std::move(file_name)), line(line), column(column),
       line_string(line_string), is_eof(is_eof) {
 }
 
@@ -0,0 +1,27 @@
+# Compiles each program of SOURCE_DIR with ELANGC, then writes its flat tree
+# with --emit-ast-bin and checks it with --load-ast-bin, and fails when the
+# two ways don't report the same diagnostics.
+
+file(GLOB programs ${SOURCE_DIR}/*.el)
+foreach(program ${programs})
+    get_filename_component(name ${program} NAME_WE)
+    set(tree ${BINARY_DIR}/${name}.bin)
+    execute_process(COMMAND ${ELANGC} ${program}
+                    OUTPUT_VARIABLE compiled)
+    execute_process(COMMAND ${ELANGC} --emit-ast-bin=${tree} ${program}
+                    OUTPUT_VARIABLE parsed RESULT_VARIABLE result)
+    # the parser diagnostics are reported when the tree is written, which
+    # doesn't happen when they stop the compilation
+    set(loaded "")
+    if(result EQUAL 0)
+        execute_process(COMMAND ${ELANGC} --load-ast-bin=${tree}
+                        OUTPUT_VARIABLE loaded)
+    endif()
+    set(loaded "${parsed}${loaded}")
+    string(REGEX MATCHALL "[^\n]*Error :[^\n]*" compiled "${compiled}")
+    string(REGEX MATCHALL "[^\n]*Error :[^\n]*" loaded "${loaded}")
+    if(NOT compiled STREQUAL loaded)
+        message(FATAL_ERROR "${name}: different diagnostics\n"
+                            "compiled: ${compiled}\nloaded: ${loaded}")
+    endif()
+endforeach()
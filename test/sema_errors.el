@@ -0,0 +1,12 @@
+func f(a : int) -> int {
+    return a;
+}
+
+func main() -> void {
+    let x = 1;
+    let d = 2.0;
+    let a = d as *int;
+    let b = f as int;
+    let c = (y + 1) as int;
+    let e = x(z, 2);
+}